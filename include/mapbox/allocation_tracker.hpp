@@ -0,0 +1,136 @@
+#ifndef MAPBOX_UTIL_ALLOCATION_TRACKER_HPP
+#define MAPBOX_UTIL_ALLOCATION_TRACKER_HPP
+
+// Counts the nodes recursive_wrapper allocates, in total and for each
+// wrapped type. Enabled by defining MAPBOX_VARIANT_TRACK_ALLOCATIONS before
+// including any header of the library, in every translation unit of the
+// program; without it recursive_wrapper.hpp does not include this header
+// and allocates without counting.
+//
+// Node bytes are sizeof(T), not counting the overhead of the allocator.
+// Counters are updated atomically, so the numbers are exact while nodes
+// are allocated and freed on several threads.
+
+#include <atomic>
+#include <cstddef>
+
+namespace mapbox {
+namespace util {
+
+struct allocation_stats
+{
+    std::size_t allocations; // nodes allocated so far
+    std::size_t live_nodes;
+    std::size_t live_bytes;
+    std::size_t peak_nodes;
+    std::size_t peak_bytes;
+};
+
+namespace detail {
+
+class allocation_counters
+{
+public:
+    void allocated(std::size_t bytes) noexcept
+    {
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        raise(peak_nodes_, live_nodes_.fetch_add(1, std::memory_order_relaxed) + 1);
+        raise(peak_bytes_, live_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+    }
+
+    void deallocated(std::size_t bytes) noexcept
+    {
+        live_nodes_.fetch_sub(1, std::memory_order_relaxed);
+        live_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    allocation_stats stats() const noexcept
+    {
+        return allocation_stats{allocations_.load(std::memory_order_relaxed),
+                                live_nodes_.load(std::memory_order_relaxed),
+                                live_bytes_.load(std::memory_order_relaxed),
+                                peak_nodes_.load(std::memory_order_relaxed),
+                                peak_bytes_.load(std::memory_order_relaxed)};
+    }
+
+    // Starts measuring the peaks again from the current live counts.
+    void reset_peaks() noexcept
+    {
+        peak_nodes_.store(live_nodes_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        peak_bytes_.store(live_bytes_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+private:
+    static void raise(std::atomic<std::size_t>& peak, std::size_t value) noexcept
+    {
+        std::size_t current = peak.load(std::memory_order_relaxed);
+        while (current < value && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    std::atomic<std::size_t> allocations_{0};
+    std::atomic<std::size_t> live_nodes_{0};
+    std::atomic<std::size_t> live_bytes_{0};
+    std::atomic<std::size_t> peak_nodes_{0};
+    std::atomic<std::size_t> peak_bytes_{0};
+};
+
+inline allocation_counters& node_allocations() noexcept
+{
+    static allocation_counters counters;
+    return counters;
+}
+
+template <typename T>
+allocation_counters& node_allocations() noexcept
+{
+    static allocation_counters counters;
+    return counters;
+}
+
+template <typename T>
+void track_allocation() noexcept
+{
+    node_allocations().allocated(sizeof(T));
+    node_allocations<T>().allocated(sizeof(T));
+}
+
+template <typename T>
+void track_deallocation() noexcept
+{
+    node_allocations().deallocated(sizeof(T));
+    node_allocations<T>().deallocated(sizeof(T));
+}
+
+} // namespace detail
+
+// Returns the counts of all recursive_wrapper nodes.
+inline allocation_stats recursive_wrapper_allocations() noexcept
+{
+    return detail::node_allocations().stats();
+}
+
+// Returns the counts of the nodes of recursive_wrapper<T>.
+template <typename T>
+allocation_stats recursive_wrapper_allocations() noexcept
+{
+    return detail::node_allocations<T>().stats();
+}
+
+// Starts measuring the peak of all nodes again, from the current count.
+inline void reset_recursive_wrapper_peaks() noexcept
+{
+    detail::node_allocations().reset_peaks();
+}
+
+template <typename T>
+void reset_recursive_wrapper_peaks() noexcept
+{
+    detail::node_allocations<T>().reset_peaks();
+}
+
+} // namespace util
+} // namespace mapbox
+
+#endif // MAPBOX_UTIL_ALLOCATION_TRACKER_HPP
@@ -0,0 +1,210 @@
+#ifndef MAPBOX_UTIL_DEEP_SIZE_HPP
+#define MAPBOX_UTIL_DEEP_SIZE_HPP
+
+#include <cstddef>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <mapbox/recursive_wrapper.hpp>
+#include <mapbox/shared_recursive_wrapper.hpp>
+#include <mapbox/variant.hpp>
+
+namespace mapbox {
+namespace util {
+
+class heap_size_counter;
+
+/**
+ * Customization point returning the heap memory a value owns, not counting
+ * sizeof(T) itself. The primary template returns 0, which is right for
+ * types that own no memory. Specialize it for types that do, adding up
+ * their members through the counter:
+ *
+ *   template <>
+ *   struct heap_size<node>
+ *   {
+ *       static std::size_t of(node const& n, heap_size_counter& count)
+ *       {
+ *           return count(n.name) + count(n.children);
+ *       }
+ *   };
+ *
+ * Enable allows partial specializations constrained with std::enable_if.
+ */
+template <typename T, typename Enable = void>
+struct heap_size
+{
+    static std::size_t of(T const&, heap_size_counter&) noexcept
+    {
+        return 0;
+    }
+};
+
+/**
+ * Walks a value and adds up the heap memory it owns. Besides the bytes it
+ * counts the recursive_wrapper and shared_recursive_wrapper nodes and how
+ * deep they are nested. A value shared by several shared_recursive_wrappers
+ * is counted once per counter.
+ *
+ * The walk recurses once per nested node, so it needs stack in proportion
+ * to the depth of the tree.
+ */
+class heap_size_counter
+{
+public:
+    template <typename T>
+    std::size_t operator()(T const& value)
+    {
+        return heap_size<T>::of(value, *this);
+    }
+
+    // Counts a heap node of node_bytes that holds value.
+    template <typename T>
+    std::size_t node(std::size_t node_bytes, T const& value)
+    {
+        if (histogram_.size() <= depth_)
+        {
+            histogram_.resize(depth_ + 1);
+        }
+        ++histogram_[depth_];
+        ++nodes_;
+        ++depth_;
+        std::size_t const bytes = node_bytes + (*this)(value);
+        --depth_;
+        return bytes;
+    }
+
+    // Returns true the first time it is called with address, so that values
+    // with several owners can be counted once.
+    bool first_visit(void const* address)
+    {
+        return visited_.insert(address).second;
+    }
+
+    // Number of nodes counted so far.
+    std::size_t nodes() const noexcept { return nodes_; }
+
+    // Element d is the number of nodes nested in d other nodes.
+    std::vector<std::size_t> const& depth_histogram() const noexcept { return histogram_; }
+
+private:
+    std::size_t depth_ = 0;
+    std::size_t nodes_ = 0;
+    std::vector<std::size_t> histogram_;
+    std::unordered_set<void const*> visited_;
+};
+
+// Returns the heap memory value owns.
+template <typename T>
+std::size_t heap_size_of(T const& value)
+{
+    heap_size_counter count;
+    return count(value);
+}
+
+// Returns the memory value takes in total: its own size and the heap
+// memory it owns.
+template <typename T>
+std::size_t deep_size_of(T const& value)
+{
+    return sizeof(T) + heap_size_of(value);
+}
+
+// Strings short enough for the small string optimization keep their
+// characters inside the object.
+template <typename CharT, typename Traits, typename Alloc>
+struct heap_size<std::basic_string<CharT, Traits, Alloc>>
+{
+    static std::size_t of(std::basic_string<CharT, Traits, Alloc> const& s, heap_size_counter&) noexcept
+    {
+        char const* const data = reinterpret_cast<char const*>(s.data());
+        char const* const object = reinterpret_cast<char const*>(&s);
+        if (data >= object && data < object + sizeof(s))
+        {
+            return 0;
+        }
+        return (s.capacity() + 1) * sizeof(CharT);
+    }
+};
+
+template <typename T, typename Alloc>
+struct heap_size<std::vector<T, Alloc>>
+{
+    static std::size_t of(std::vector<T, Alloc> const& v, heap_size_counter& count)
+    {
+        std::size_t bytes = v.capacity() * sizeof(T);
+        for (T const& element : v)
+        {
+            bytes += count(element);
+        }
+        return bytes;
+    }
+};
+
+template <typename First, typename Second>
+struct heap_size<std::pair<First, Second>>
+{
+    static std::size_t of(std::pair<First, Second> const& p, heap_size_counter& count)
+    {
+        return count(p.first) + count(p.second);
+    }
+};
+
+template <typename T, typename Alloc>
+struct heap_size<recursive_wrapper<T, Alloc>>
+{
+    static std::size_t of(recursive_wrapper<T, Alloc> const& w, heap_size_counter& count)
+    {
+        T const* const p = w.get_pointer();
+        return p ? count.node(sizeof(T), *p) : 0;
+    }
+};
+
+template <typename T>
+struct heap_size<shared_recursive_wrapper<T>>
+{
+    static std::size_t of(shared_recursive_wrapper<T> const& w, heap_size_counter& count)
+    {
+        T const* const p = w.get_pointer();
+        if (!p || !count.first_visit(p))
+        {
+            return 0;
+        }
+        return count.node(shared_recursive_wrapper<T>::node_size(), *p);
+    }
+};
+
+// Looks at the stored alternative itself rather than visiting it, as
+// visitation would unwrap recursive_wrapper and hide its node.
+template <typename... Types>
+struct heap_size<variant<Types...>>
+{
+    static std::size_t of(variant<Types...> const& v, heap_size_counter& count)
+    {
+        return alternative<0, Types...>(v, count);
+    }
+
+private:
+    template <int I, typename T, typename... Rest>
+    static std::size_t alternative(variant<Types...> const& v, heap_size_counter& count)
+    {
+        if (v.which() == I)
+        {
+            return count(v.template get_unchecked<T>());
+        }
+        return alternative<I + 1, Rest...>(v, count);
+    }
+
+    template <int I>
+    static std::size_t alternative(variant<Types...> const&, heap_size_counter&) noexcept
+    {
+        return 0;
+    }
+};
+
+} // namespace util
+} // namespace mapbox
+
+#endif // MAPBOX_UTIL_DEEP_SIZE_HPP
@@ -0,0 +1,64 @@
+#ifndef MAPBOX_UTIL_DETAIL_COLUMNS_HPP
+#define MAPBOX_UTIL_DETAIL_COLUMNS_HPP
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <mapbox/variant.hpp>
+
+namespace mapbox {
+namespace util {
+namespace detail {
+
+// Zero based position and type of the alternative of Types... holding a T,
+// either directly or in a wrapper, and the type of the value it holds. Used
+// by the containers storing the values of each alternative apart.
+template <typename T, typename... Types>
+struct alternative_of
+{
+    static constexpr type_index_t stored = direct_type<T, Types...>::index != invalid_value
+                                               ? direct_type<T, Types...>::index
+                                               : wrapper_type<T, Types...>::index;
+    static constexpr bool is_valid = stored != invalid_value;
+    static constexpr std::size_t index = is_valid ? sizeof...(Types) - stored - 1 : 0;
+    using type = typename std::tuple_element<index, std::tuple<Types...>>::type;
+    using value_type = typename std::remove_reference<decltype(unwrapper<type>::apply(std::declval<type&>()))>::type;
+};
+
+// A bool taking a byte, so that a column of bools is not a bit packed
+// std::vector<bool>, whose elements cannot be referenced.
+struct bool_cell
+{
+    bool value;
+
+    bool_cell(bool v = false) noexcept
+        : value(v) {}
+};
+
+// Type stored for the alternative T by the containers storing the values
+// of each alternative apart.
+template <typename T>
+struct vector_column
+{
+    using type = T;
+
+    static T& get(T& value) noexcept { return value; }
+    static T const& get(T const& value) noexcept { return value; }
+};
+
+template <>
+struct vector_column<bool>
+{
+    using type = bool_cell;
+
+    static bool& get(bool_cell& cell) noexcept { return cell.value; }
+    static bool const& get(bool_cell const& cell) noexcept { return cell.value; }
+};
+
+} // namespace detail
+} // namespace util
+} // namespace mapbox
+
+#endif // MAPBOX_UTIL_DETAIL_COLUMNS_HPP
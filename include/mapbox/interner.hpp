@@ -0,0 +1,231 @@
+#ifndef MAPBOX_UTIL_INTERNER_HPP
+#define MAPBOX_UTIL_INTERNER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include <mapbox/shared_recursive_wrapper.hpp>
+#include <mapbox/variant.hpp>
+
+namespace mapbox {
+namespace util {
+
+namespace detail {
+
+template <typename Variant>
+struct identity_hasher
+{
+    template <typename T>
+    std::size_t operator()(T const& value) const
+    {
+        return hash(value, is_shared_alternative<T, typename Variant::types>());
+    }
+
+    template <typename T>
+    static std::size_t hash(T const& value, std::true_type)
+    {
+        return std::hash<T const*>()(std::addressof(value));
+    }
+
+    template <typename T>
+    static std::size_t hash(T const& value, std::false_type)
+    {
+        return std::hash<T>()(value);
+    }
+};
+
+template <typename Variant>
+class identity_comparer
+{
+public:
+    explicit identity_comparer(Variant const& lhs) noexcept
+        : lhs_(lhs) {}
+    identity_comparer& operator=(identity_comparer const&) = delete;
+
+    template <typename T>
+    bool operator()(T const& rhs_content) const
+    {
+        return equal(lhs_.template get_unchecked<T>(), rhs_content,
+                     is_shared_alternative<T, typename Variant::types>());
+    }
+
+private:
+    template <typename T>
+    static bool equal(T const& lhs, T const& rhs, std::true_type)
+    {
+        return std::addressof(lhs) == std::addressof(rhs);
+    }
+
+    template <typename T>
+    static bool equal(T const& lhs, T const& rhs, std::false_type)
+    {
+        return lhs == rhs;
+    }
+
+    Variant const& lhs_;
+};
+
+} // namespace detail
+
+/**
+ * Hashes a variant by the value it holds, except for values held in a
+ * shared_recursive_wrapper, which are hashed by their address. In a tree
+ * built by an interner, equal subtrees share one node, so this hashes
+ * structurally without looking into the subtrees.
+ */
+struct identity_hash
+{
+    template <typename... Types>
+    std::size_t operator()(variant<Types...> const& v) const
+    {
+        std::size_t const h = apply_visitor(detail::identity_hasher<variant<Types...>>(), v);
+        return h ^ (static_cast<std::size_t>(v.which()) + 0x9e3779b9 + (h << 6) + (h >> 2));
+    }
+};
+
+/**
+ * Compares variants like operator==, except for values held in a
+ * shared_recursive_wrapper, which are equal only if they are the same
+ * node. For trees built by the same interner this is structural equality
+ * in constant time.
+ */
+struct identity_equal
+{
+    template <typename... Types>
+    bool operator()(variant<Types...> const& lhs, variant<Types...> const& rhs) const
+    {
+        if (lhs.which() != rhs.which())
+        {
+            return false;
+        }
+        return apply_visitor(detail::identity_comparer<variant<Types...>>(lhs), rhs);
+    }
+};
+
+/**
+ * Hash-consing factory for nodes of recursive variants. Interning a value
+ * that is equal to one interned before returns a wrapper sharing the node
+ * of the earlier value, so each distinct subtree is stored once.
+ *
+ * Hash and Equal are applied to a single node. For children that are
+ * themselves interned, they should hash and compare the children with
+ * identity_hash and identity_equal, so that interning a node does not walk
+ * its subtrees.
+ *
+ * Each node gets an id, counting up from zero in the order nodes are first
+ * interned, which visitors can use to memoize their results. Ids are not
+ * reused. The interner keeps its nodes alive until collect() is called.
+ * It is not thread safe.
+ */
+template <typename T, typename Hash = std::hash<T>, typename Equal = std::equal_to<T>>
+class interner
+{
+    struct key_hash
+    {
+        Hash hash;
+
+        std::size_t operator()(T const* key) const
+        {
+            return hash(*key);
+        }
+    };
+
+    struct key_equal
+    {
+        Equal equal;
+
+        bool operator()(T const* lhs, T const* rhs) const
+        {
+            return lhs == rhs || equal(*lhs, *rhs);
+        }
+    };
+
+    struct entry
+    {
+        shared_recursive_wrapper<T> node;
+        std::size_t id;
+    };
+
+    // keyed by the interned values, which stay in place while they are held
+    std::unordered_map<T const*, entry, key_hash, key_equal> nodes_;
+    std::size_t next_id_ = 0;
+
+    template <typename U>
+    shared_recursive_wrapper<T> insert(U&& value)
+    {
+        auto it = nodes_.find(std::addressof(value));
+        if (it != nodes_.end())
+        {
+            return it->second.node;
+        }
+        shared_recursive_wrapper<T> const node(std::forward<U>(value));
+        nodes_.emplace(node.get_pointer(), entry{node, next_id_});
+        ++next_id_;
+        return node;
+    }
+
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    explicit interner(Hash const& hash = Hash(), Equal const& equal = Equal())
+        : nodes_(0, key_hash{hash}, key_equal{equal}) {}
+
+    shared_recursive_wrapper<T> intern(T const& value)
+    {
+        return insert(value);
+    }
+
+    shared_recursive_wrapper<T> intern(T&& value)
+    {
+        return insert(std::move(value));
+    }
+
+    // Id of the interned node equal to value, or npos if there is none.
+    std::size_t id(T const& value) const
+    {
+        auto it = nodes_.find(std::addressof(value));
+        return it != nodes_.end() ? it->second.id : npos;
+    }
+
+    // Number of distinct nodes interned.
+    std::size_t size() const noexcept
+    {
+        return nodes_.size();
+    }
+
+    // Drops the nodes that are only held by the interner, and returns how
+    // many were dropped. Dropping a node can free its children as well.
+    std::size_t collect()
+    {
+        std::size_t const before = nodes_.size();
+        for (bool dropped = true; dropped;)
+        {
+            dropped = false;
+            for (auto it = nodes_.begin(); it != nodes_.end();)
+            {
+                if (it->second.node.use_count() == 1)
+                {
+                    it = nodes_.erase(it);
+                    dropped = true;
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+        return before - nodes_.size();
+    }
+};
+
+template <typename T, typename Hash, typename Equal>
+constexpr std::size_t interner<T, Hash, Equal>::npos;
+
+} // namespace util
+} // namespace mapbox
+
+#endif // MAPBOX_UTIL_INTERNER_HPP
@@ -0,0 +1,491 @@
+#ifndef MAPBOX_UTIL_NUMERIC_KERNELS_HPP
+#define MAPBOX_UTIL_NUMERIC_KERNELS_HPP
+
+// Arithmetic over columns of numbers that may be bools, signed or unsigned
+// 64 bit integers or doubles, stored in a numeric_column. Rather than
+// visiting the values one by one, the kernels work on runs of values of the
+// same type: a reduction runs one loop per column of the variant_vector, and
+// an element wise operation one loop per run of positions where both
+// operands keep their types. The loops work on plain arrays of one type and
+// are written so that the compiler can vectorize them.
+//
+// Values are combined as by the scalar visitors numeric_plus,
+// numeric_multiplies, numeric_less and numeric_equal_to: both operands are
+// converted to their promoted type, double if either is a double, otherwise
+// std::uint64_t if either is one, otherwise std::int64_t. Integer arithmetic
+// wraps around.
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <mapbox/tag_algorithms.hpp>
+#include <mapbox/variant.hpp>
+#include <mapbox/variant_vector.hpp>
+
+namespace mapbox {
+namespace util {
+
+using numeric_value = variant<bool, std::int64_t, std::uint64_t, double>;
+using numeric_column = variant_vector<bool, std::int64_t, std::uint64_t, double>;
+
+namespace detail {
+
+template <typename A, typename B>
+struct numeric_promotion
+{
+    using type = typename std::conditional<
+        std::is_same<A, double>::value || std::is_same<B, double>::value, double,
+        typename std::conditional<std::is_same<A, std::uint64_t>::value || std::is_same<B, std::uint64_t>::value,
+                                  std::uint64_t, std::int64_t>::type>::type;
+};
+
+template <typename A, typename B>
+using numeric_promotion_t = typename numeric_promotion<A, B>::type;
+
+template <typename R>
+struct numeric_arithmetic
+{
+    static R add(R a, R b) noexcept { return a + b; }
+    static R multiply(R a, R b) noexcept { return a * b; }
+};
+
+// Signed overflow is undefined, so add and multiply as unsigned.
+template <>
+struct numeric_arithmetic<std::int64_t>
+{
+    static std::int64_t add(std::int64_t a, std::int64_t b) noexcept
+    {
+        return static_cast<std::int64_t>(static_cast<std::uint64_t>(a) + static_cast<std::uint64_t>(b));
+    }
+
+    static std::int64_t multiply(std::int64_t a, std::int64_t b) noexcept
+    {
+        return static_cast<std::int64_t>(static_cast<std::uint64_t>(a) * static_cast<std::uint64_t>(b));
+    }
+};
+
+struct numeric_plus_op
+{
+    template <typename R>
+    static R apply(R a, R b) noexcept { return numeric_arithmetic<R>::add(a, b); }
+};
+
+struct numeric_multiplies_op
+{
+    template <typename R>
+    static R apply(R a, R b) noexcept { return numeric_arithmetic<R>::multiply(a, b); }
+};
+
+struct numeric_less_op
+{
+    template <typename R>
+    static bool apply(R a, R b) noexcept { return a < b; }
+};
+
+struct numeric_equal_to_op
+{
+    template <typename R>
+    static bool apply(R a, R b) noexcept { return a == b; }
+};
+
+} // namespace detail
+
+struct numeric_plus
+{
+    template <typename A, typename B>
+    numeric_value operator()(A a, B b) const noexcept
+    {
+        using R = detail::numeric_promotion_t<A, B>;
+        return numeric_value(detail::numeric_plus_op::apply(static_cast<R>(a), static_cast<R>(b)));
+    }
+};
+
+struct numeric_multiplies
+{
+    template <typename A, typename B>
+    numeric_value operator()(A a, B b) const noexcept
+    {
+        using R = detail::numeric_promotion_t<A, B>;
+        return numeric_value(detail::numeric_multiplies_op::apply(static_cast<R>(a), static_cast<R>(b)));
+    }
+};
+
+struct numeric_less
+{
+    template <typename A, typename B>
+    bool operator()(A a, B b) const noexcept
+    {
+        using R = detail::numeric_promotion_t<A, B>;
+        return detail::numeric_less_op::apply(static_cast<R>(a), static_cast<R>(b));
+    }
+};
+
+struct numeric_equal_to
+{
+    template <typename A, typename B>
+    bool operator()(A a, B b) const noexcept
+    {
+        using R = detail::numeric_promotion_t<A, B>;
+        return detail::numeric_equal_to_op::apply(static_cast<R>(a), static_cast<R>(b));
+    }
+};
+
+namespace detail {
+
+template <std::size_t I>
+using numeric_type = typename std::tuple_element<I, std::tuple<bool, std::int64_t, std::uint64_t, double>>::type;
+
+template <typename T>
+using numeric_cell = typename vector_column<T>::type;
+
+// Throws if ok is false. Without exceptions it asserts and returns ok, so
+// that the caller can return a defined result.
+inline bool check_numeric_argument(bool ok, char const* message)
+{
+    if (!ok)
+    {
+#ifdef HAS_EXCEPTIONS
+        throw std::invalid_argument(message);
+#else
+        (void)message;
+        assert(false);
+#endif
+    }
+    return ok;
+}
+
+template <std::size_t I>
+numeric_cell<numeric_type<I>> const* column_data(numeric_column const& c) noexcept
+{
+    return c.template column<I>().data();
+}
+
+// Sum of the values of a column converted to R. Four partial sums let the
+// additions of doubles overlap, and be vectorized without reassociating
+// the additions of one partial sum. Integers are added up as
+// std::uint64_t, which wraps around like numeric_arithmetic.
+template <typename R, typename T>
+R sum_as(numeric_cell<T> const* values, std::size_t size) noexcept
+{
+    using accumulator = typename std::conditional<std::is_integral<R>::value, std::uint64_t, R>::type;
+    accumulator partial[4] = {accumulator(0), accumulator(0), accumulator(0), accumulator(0)};
+    std::size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+        for (std::size_t lane = 0; lane < 4; ++lane)
+        {
+            partial[lane] += static_cast<accumulator>(static_cast<R>(vector_column<T>::get(values[i + lane])));
+        }
+    }
+    for (; i < size; ++i)
+    {
+        partial[0] += static_cast<accumulator>(static_cast<R>(vector_column<T>::get(values[i])));
+    }
+    return static_cast<R>((partial[0] + partial[1]) + (partial[2] + partial[3]));
+}
+
+template <typename R>
+R column_sum_as(numeric_column const& c) noexcept
+{
+    R sum = sum_as<R, bool>(column_data<0>(c), c.column<0>().size());
+    sum = numeric_arithmetic<R>::add(sum, sum_as<R, std::int64_t>(column_data<1>(c), c.column<1>().size()));
+    sum = numeric_arithmetic<R>::add(sum, sum_as<R, std::uint64_t>(column_data<2>(c), c.column<2>().size()));
+    return numeric_arithmetic<R>::add(sum, sum_as<R, double>(column_data<3>(c), c.column<3>().size()));
+}
+
+// The least (or with Greatest the greatest) value of a non empty column,
+// comparing like a scalar loop keeping the first value and replacing it by
+// each value that is less.
+template <bool Greatest, typename T>
+T extreme_of(numeric_cell<T> const* values, std::size_t size) noexcept
+{
+    assert(size != 0);
+    T const first = vector_column<T>::get(values[0]);
+    T partial[4] = {first, first, first, first};
+    std::size_t i = 1;
+    for (; i + 4 <= size; i += 4)
+    {
+        for (std::size_t lane = 0; lane < 4; ++lane)
+        {
+            T const v = vector_column<T>::get(values[i + lane]);
+            partial[lane] = (Greatest ? partial[lane] < v : v < partial[lane]) ? v : partial[lane];
+        }
+    }
+    for (; i < size; ++i)
+    {
+        T const v = vector_column<T>::get(values[i]);
+        partial[0] = (Greatest ? partial[0] < v : v < partial[0]) ? v : partial[0];
+    }
+    T result = partial[0];
+    for (std::size_t lane = 1; lane < 4; ++lane)
+    {
+        result = (Greatest ? result < partial[lane] : partial[lane] < result) ? partial[lane] : result;
+    }
+    return result;
+}
+
+template <bool Greatest, std::size_t I>
+void combine_extreme(numeric_column const& c, numeric_value& result, bool& found)
+{
+    using T = numeric_type<I>;
+    if (c.column<I>().empty())
+    {
+        return;
+    }
+    numeric_value const candidate{extreme_of<Greatest, T>(column_data<I>(c), c.column<I>().size())};
+    if (!found || apply_visitor(numeric_less(), Greatest ? result : candidate, Greatest ? candidate : result))
+    {
+        result = candidate;
+        found = true;
+    }
+}
+
+template <bool Greatest>
+numeric_value column_extreme(numeric_column const& c)
+{
+    numeric_value result;
+    if (!check_numeric_argument(!c.empty(), "numeric column is empty"))
+    {
+        return result;
+    }
+    bool found = false;
+    combine_extreme<Greatest, 0>(c, result, found);
+    combine_extreme<Greatest, 1>(c, result, found);
+    combine_extreme<Greatest, 2>(c, result, found);
+    combine_extreme<Greatest, 3>(c, result, found);
+    return result;
+}
+
+// The run kernels compare tags with match_64, so they live in the same
+// instruction set namespace as the tag queries.
+inline namespace MAPBOX_VARIANT_TAG_SIMD_NAMESPACE {
+
+// Length of the run of positions from position on where the tags of a and
+// b stay as they are at position.
+inline std::size_t common_run(tag_type const* a, tag_type const* b, std::size_t position, std::size_t size) noexcept
+{
+    tag_type const ta = a[position];
+    tag_type const tb = b[position];
+    std::size_t end = position;
+    while (size - end >= 64)
+    {
+        std::uint64_t const same = match_64(a + end, ta) & match_64(b + end, tb);
+        if (same != ~std::uint64_t(0))
+        {
+            return end + lowest_bit(~same) - position;
+        }
+        end += 64;
+    }
+    std::uint64_t const same = match_tail(a + end, size - end, ta) & match_tail(b + end, size - end, tb);
+    return end + lowest_bit(~same) - position;
+}
+
+// Writes op applied to the run of size values starting at a and b to the
+// column of their promoted type, from out_offset on.
+template <typename Op, std::size_t K>
+void arithmetic_run(numeric_column const& a, std::size_t a_offset, numeric_column const& b, std::size_t b_offset,
+                    std::size_t size, numeric_column& out, std::size_t out_offset)
+{
+    using A = numeric_type<K / 4>;
+    using B = numeric_type<K % 4>;
+    using R = numeric_promotion_t<A, B>;
+    numeric_cell<A> const* const x = column_data<K / 4>(a) + a_offset;
+    numeric_cell<B> const* const y = column_data<K % 4>(b) + b_offset;
+    R* const result = out.values<numeric_column::tag_of<R>()>().data() + out_offset;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        result[i] = Op::apply(static_cast<R>(vector_column<A>::get(x[i])), static_cast<R>(vector_column<B>::get(y[i])));
+    }
+}
+
+// Writes op applied to the run of size values starting at a and b to out.
+template <typename Op, std::size_t K>
+void comparison_run(numeric_column const& a, std::size_t a_offset, numeric_column const& b, std::size_t b_offset,
+                    std::size_t size, tag_type* out)
+{
+    using A = numeric_type<K / 4>;
+    using B = numeric_type<K % 4>;
+    using R = numeric_promotion_t<A, B>;
+    numeric_cell<A> const* const x = column_data<K / 4>(a) + a_offset;
+    numeric_cell<B> const* const y = column_data<K % 4>(b) + b_offset;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        out[i] = Op::apply(static_cast<R>(vector_column<A>::get(x[i])), static_cast<R>(vector_column<B>::get(y[i])));
+    }
+}
+
+// The tags of the results are known up front, as the promoted type is the
+// greatest of bool, std::int64_t, std::uint64_t and double, in the order of
+// the alternatives, and at least std::int64_t. The values are then written
+// in place, run by run.
+template <typename Op, std::size_t... Ks>
+void column_arithmetic(numeric_column const& a, numeric_column const& b, numeric_column& out, index_sequence<Ks...>)
+{
+    if (!check_numeric_argument(&out != &a && &out != &b, "numeric column result overlaps an operand"))
+    {
+        return;
+    }
+    if (!check_numeric_argument(a.size() == b.size(), "numeric columns differ in size"))
+    {
+        out.clear();
+        return;
+    }
+    using function_type = void (*)(numeric_column const&, std::size_t, numeric_column const&, std::size_t,
+                                   std::size_t, numeric_column&, std::size_t);
+    static constexpr function_type table[] = {&arithmetic_run<Op, Ks>...};
+    tag_type const* const a_tags = a.tags().data();
+    tag_type const* const b_tags = b.tags().data();
+    out.assign_tags(a.size(), [a_tags, b_tags](std::size_t i) {
+        tag_type const greater = a_tags[i] < b_tags[i] ? b_tags[i] : a_tags[i];
+        return greater < 1 ? tag_type(1) : greater;
+    });
+    for (std::size_t i = 0; i < a.size();)
+    {
+        std::size_t const run = common_run(a_tags, b_tags, i, a.size());
+        table[4u * a_tags[i] + b_tags[i]](a, a.offsets()[i], b, b.offsets()[i], run, out, out.offsets()[i]);
+        i += run;
+    }
+}
+
+template <typename Op, std::size_t... Ks>
+void column_comparison(numeric_column const& a, numeric_column const& b, tag_bitmask& out, index_sequence<Ks...>)
+{
+    if (!check_numeric_argument(a.size() == b.size(), "numeric columns differ in size"))
+    {
+        out.clear();
+        return;
+    }
+    using function_type = void (*)(numeric_column const&, std::size_t, numeric_column const&, std::size_t,
+                                   std::size_t, tag_type*);
+    static constexpr function_type table[] = {&comparison_run<Op, Ks>...};
+    std::vector<tag_type> results(a.size());
+    for (std::size_t i = 0; i < a.size();)
+    {
+        std::size_t const run = common_run(a.tags().data(), b.tags().data(), i, a.size());
+        table[4u * a.tags()[i] + b.tags()[i]](a, a.offsets()[i], b, b.offsets()[i], run, results.data() + i);
+        i += run;
+    }
+    out.assign((a.size() + 63) / 64, 0);
+    for_each_match_word(results.data(), results.size(), 1, 0, [&out](std::size_t word, std::uint64_t bits) {
+        out[word] = bits;
+        return true;
+    });
+}
+
+} // namespace MAPBOX_VARIANT_TAG_SIMD_NAMESPACE
+} // namespace detail
+
+// The sum of the values, of the promoted type of all of them, or
+// std::int64_t(0) for an empty column. Equal to converting every value to
+// that type and adding them up; sums of doubles may differ from adding in
+// order in the last bits, as the additions are reordered.
+inline numeric_value column_sum(numeric_column const& c)
+{
+    if (!c.column<3>().empty())
+    {
+        return numeric_value(detail::column_sum_as<double>(c));
+    }
+    if (!c.column<2>().empty())
+    {
+        return numeric_value(detail::column_sum_as<std::uint64_t>(c));
+    }
+    return numeric_value(detail::column_sum_as<std::int64_t>(c));
+}
+
+// The mean of the values converted to double, NaN for an empty column.
+inline double column_mean(numeric_column const& c)
+{
+    if (c.empty())
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return detail::column_sum_as<double>(c) / static_cast<double>(c.size());
+}
+
+// The least value, compared with numeric_less. Among equal values of
+// different types, the one of the type listed first in numeric_value is
+// returned. Like numeric_less, this compares a negative std::int64_t with a
+// std::uint64_t as a std::uint64_t, so a column mixing the two may have no
+// least value; the result is then the least of the least values of each
+// type. Throws std::invalid_argument for an empty column; without
+// exceptions, asserts and returns a value initialized numeric_value.
+inline numeric_value column_min(numeric_column const& c)
+{
+    return detail::column_extreme<false>(c);
+}
+
+// The greatest value, like column_min.
+inline numeric_value column_max(numeric_column const& c)
+{
+    return detail::column_extreme<true>(c);
+}
+
+inline namespace MAPBOX_VARIANT_TAG_SIMD_NAMESPACE {
+
+// Element wise a[i] + b[i] and a[i] * b[i] as numeric_plus and
+// numeric_multiplies compute them, written to out, whose memory is reused.
+// Throws std::invalid_argument if the columns differ in size or out is
+// one of them; without exceptions, asserts and leaves out empty, or
+// unchanged if it is one of them.
+inline void column_add(numeric_column const& a, numeric_column const& b, numeric_column& out)
+{
+    detail::column_arithmetic<detail::numeric_plus_op>(a, b, out, detail::make_index_sequence<16>());
+}
+
+inline void column_multiply(numeric_column const& a, numeric_column const& b, numeric_column& out)
+{
+    detail::column_arithmetic<detail::numeric_multiplies_op>(a, b, out, detail::make_index_sequence<16>());
+}
+
+inline numeric_column column_add(numeric_column const& a, numeric_column const& b)
+{
+    numeric_column out;
+    column_add(a, b, out);
+    return out;
+}
+
+inline numeric_column column_multiply(numeric_column const& a, numeric_column const& b)
+{
+    numeric_column out;
+    column_multiply(a, b, out);
+    return out;
+}
+
+// Bitmasks of the positions where a[i] < b[i] and a[i] == b[i], as
+// numeric_less and numeric_equal_to compute them, written to out. Throws
+// std::invalid_argument if the columns differ in size; without exceptions,
+// asserts and leaves out empty.
+inline void column_less(numeric_column const& a, numeric_column const& b, tag_bitmask& out)
+{
+    detail::column_comparison<detail::numeric_less_op>(a, b, out, detail::make_index_sequence<16>());
+}
+
+inline void column_equal(numeric_column const& a, numeric_column const& b, tag_bitmask& out)
+{
+    detail::column_comparison<detail::numeric_equal_to_op>(a, b, out, detail::make_index_sequence<16>());
+}
+
+inline tag_bitmask column_less(numeric_column const& a, numeric_column const& b)
+{
+    tag_bitmask out;
+    column_less(a, b, out);
+    return out;
+}
+
+inline tag_bitmask column_equal(numeric_column const& a, numeric_column const& b)
+{
+    tag_bitmask out;
+    column_equal(a, b, out);
+    return out;
+}
+
+} // namespace MAPBOX_VARIANT_TAG_SIMD_NAMESPACE
+} // namespace util
+} // namespace mapbox
+
+#endif // MAPBOX_UTIL_NUMERIC_KERNELS_HPP
@@ -0,0 +1,383 @@
+#ifndef MAPBOX_UTIL_POOL_ALLOCATOR_HPP
+#define MAPBOX_UTIL_POOL_ALLOCATOR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <new>
+
+#include <mapbox/recursive_wrapper.hpp>
+
+// Number of free nodes each thread keeps for itself. Once a thread holds
+// more, half of them are handed to the global list.
+#ifndef MAPBOX_VARIANT_POOL_LOCAL_CAPACITY
+#define MAPBOX_VARIANT_POOL_LOCAL_CAPACITY 256
+#endif
+
+// Number of free nodes the global list holds at most, for all threads.
+// Nodes beyond that are returned to the system.
+#ifndef MAPBOX_VARIANT_POOL_GLOBAL_CAPACITY
+#define MAPBOX_VARIANT_POOL_GLOBAL_CAPACITY 16384
+#endif
+
+namespace mapbox {
+namespace util {
+
+struct pool_stats
+{
+    std::size_t allocations;         // nodes handed out
+    std::size_t deallocations;       // nodes given back
+    std::size_t system_allocations;  // nodes taken from operator new
+    std::size_t system_deallocations; // nodes returned to operator delete
+    std::size_t refills;             // batches moved from the global list to a thread
+    std::size_t spills;              // batches moved from a thread to the global list
+    std::size_t global_free;         // free nodes in the global list
+};
+
+namespace detail {
+
+// Free list of nodes of one type. Each thread pops and pushes nodes on its
+// own list without synchronization. Threads exchange nodes with a global
+// list in batches, under a mutex.
+template <typename T>
+class node_pool
+{
+    struct free_node
+    {
+        free_node* next;
+    };
+
+    static constexpr std::size_t node_size = sizeof(T) < sizeof(free_node) ? sizeof(free_node) : sizeof(T);
+    static constexpr std::size_t local_capacity = MAPBOX_VARIANT_POOL_LOCAL_CAPACITY;
+    static constexpr std::size_t batch_size = local_capacity / 2 > 0 ? local_capacity / 2 : 1;
+    static constexpr std::size_t global_capacity = MAPBOX_VARIANT_POOL_GLOBAL_CAPACITY;
+
+    static_assert(alignof(T) <= alignof(std::max_align_t), "node_pool does not support over-aligned types.");
+
+    struct free_list
+    {
+        free_node* head = nullptr;
+        std::size_t size = 0;
+
+        void push(free_node* node) noexcept
+        {
+            node->next = head;
+            head = node;
+            ++size;
+        }
+
+        free_node* pop() noexcept
+        {
+            free_node* node = head;
+            head = node->next;
+            --size;
+            return node;
+        }
+
+        // Moves up to count nodes from the front of this list to other.
+        void transfer(free_list& other, std::size_t count) noexcept
+        {
+            while (count-- > 0 && head)
+            {
+                other.push(pop());
+            }
+        }
+    };
+
+    struct global_state
+    {
+        std::mutex mutex;
+        free_list list;
+        std::atomic<std::size_t> list_size{0}; // readable without the mutex
+        std::atomic<std::size_t> allocations{0};
+        std::atomic<std::size_t> deallocations{0};
+        std::atomic<std::size_t> system_allocations{0};
+        std::atomic<std::size_t> system_deallocations{0};
+        std::atomic<std::size_t> refills{0};
+        std::atomic<std::size_t> spills{0};
+    };
+
+    // Never destroyed, so that nodes can still be freed while static
+    // objects are destroyed at exit.
+    static global_state& global()
+    {
+        static global_state* state = new global_state;
+        return *state;
+    }
+
+    static void* system_allocate()
+    {
+        global().system_allocations.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(node_size);
+    }
+
+    static void system_deallocate(free_node* node) noexcept
+    {
+        global().system_deallocations.fetch_add(1, std::memory_order_relaxed);
+        ::operator delete(node);
+    }
+
+    // Hands nodes to the global list, and those that do not fit back to
+    // the system.
+    static void spill(free_list& list, std::size_t count) noexcept
+    {
+        global_state& g = global();
+        {
+            std::lock_guard<std::mutex> lock(g.mutex);
+            std::size_t const room = global_capacity - g.list.size;
+            std::size_t const moved = count < room ? count : room;
+            list.transfer(g.list, moved);
+            g.list_size.store(g.list.size, std::memory_order_relaxed);
+            count -= moved;
+        }
+        g.spills.fetch_add(1, std::memory_order_relaxed);
+        while (count-- > 0 && list.head)
+        {
+            system_deallocate(list.pop());
+        }
+    }
+
+    enum class cache_state : unsigned char
+    {
+        unused,
+        alive,
+        destroyed
+    };
+
+    // The counts of allocations and deallocations are only added to the
+    // global ones when the thread goes to the global list, to keep other
+    // threads off their cache line.
+    struct local_cache
+    {
+        free_list list;
+        std::size_t allocations = 0;
+        std::size_t deallocations = 0;
+
+        local_cache()
+        {
+            global(); // make sure it outlives this cache
+            state() = cache_state::alive;
+        }
+
+        ~local_cache()
+        {
+            flush();
+            spill(list, list.size);
+            state() = cache_state::destroyed;
+        }
+
+        void flush() noexcept
+        {
+            global_state& g = global();
+            g.allocations.fetch_add(allocations, std::memory_order_relaxed);
+            g.deallocations.fetch_add(deallocations, std::memory_order_relaxed);
+            allocations = 0;
+            deallocations = 0;
+        }
+    };
+
+    // Trivially destructible, so that it can still be read after the cache
+    // of the thread has been destroyed.
+    static cache_state& state() noexcept
+    {
+        static thread_local cache_state s = cache_state::unused;
+        return s;
+    }
+
+    static local_cache* local() noexcept
+    {
+        if (state() == cache_state::destroyed)
+        {
+            return nullptr;
+        }
+        static thread_local local_cache cache;
+        return &cache;
+    }
+
+public:
+    static void* allocate()
+    {
+        global_state& g = global();
+        local_cache* cache = local();
+        if (!cache)
+        {
+            g.allocations.fetch_add(1, std::memory_order_relaxed);
+            return system_allocate();
+        }
+        ++cache->allocations;
+        if (!cache->list.head)
+        {
+            if (g.list_size.load(std::memory_order_relaxed) == 0)
+            {
+                return system_allocate();
+            }
+            cache->flush();
+            {
+                std::lock_guard<std::mutex> lock(g.mutex);
+                g.list.transfer(cache->list, batch_size);
+                g.list_size.store(g.list.size, std::memory_order_relaxed);
+            }
+            if (!cache->list.head)
+            {
+                return system_allocate();
+            }
+            g.refills.fetch_add(1, std::memory_order_relaxed);
+        }
+        return cache->list.pop();
+    }
+
+    static void deallocate(void* p) noexcept
+    {
+        free_node* node = static_cast<free_node*>(p);
+        local_cache* cache = local();
+        if (!cache)
+        {
+            global().deallocations.fetch_add(1, std::memory_order_relaxed);
+            free_list list;
+            list.push(node);
+            spill(list, 1);
+            return;
+        }
+        ++cache->deallocations;
+        cache->list.push(node);
+        if (cache->list.size > local_capacity)
+        {
+            cache->flush();
+            spill(cache->list, batch_size);
+        }
+    }
+
+    // Counts of other threads are only complete once they have gone to the
+    // global list or exited.
+    static pool_stats stats()
+    {
+        if (local_cache* cache = local())
+        {
+            cache->flush();
+        }
+        global_state& g = global();
+        pool_stats s;
+        s.allocations = g.allocations.load(std::memory_order_relaxed);
+        s.deallocations = g.deallocations.load(std::memory_order_relaxed);
+        s.system_allocations = g.system_allocations.load(std::memory_order_relaxed);
+        s.system_deallocations = g.system_deallocations.load(std::memory_order_relaxed);
+        s.refills = g.refills.load(std::memory_order_relaxed);
+        s.spills = g.spills.load(std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(g.mutex);
+            s.global_free = g.list.size;
+        }
+        return s;
+    }
+
+    // Returns the free nodes of the calling thread and of the global list
+    // to the system.
+    static void release()
+    {
+        if (local_cache* cache = local())
+        {
+            while (cache->list.head)
+            {
+                system_deallocate(cache->list.pop());
+            }
+        }
+        global_state& g = global();
+        free_list list;
+        {
+            std::lock_guard<std::mutex> lock(g.mutex);
+            g.list.transfer(list, g.list.size);
+            g.list_size.store(0, std::memory_order_relaxed);
+        }
+        while (list.head)
+        {
+            system_deallocate(list.pop());
+        }
+    }
+};
+
+} // namespace detail
+
+/**
+ * Allocator keeping freed nodes of type T in per-thread free lists, so that
+ * allocating and freeing a node is usually a pointer pop or push. Threads
+ * that free more nodes than they allocate hand them on through a bounded
+ * global list. Only allocations of single objects are pooled.
+ *
+ * Use it as the allocator of recursive_wrapper for trees that are modified
+ * all the time, see pooled_recursive_wrapper.
+ */
+template <typename T>
+class pool_allocator
+{
+public:
+    using value_type = T;
+
+    pool_allocator() noexcept = default;
+
+    template <typename U>
+    pool_allocator(pool_allocator<U> const&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+        if (n != 1)
+        {
+            if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+            {
+#if defined(__EXCEPTIONS) || defined(_MSC_VER)
+                throw std::bad_array_new_length();
+#else
+                std::abort();
+#endif
+            }
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T*>(detail::node_pool<T>::allocate());
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        if (n != 1)
+        {
+            ::operator delete(p);
+            return;
+        }
+        detail::node_pool<T>::deallocate(p);
+    }
+
+    // Statistics of the pool of T, over all threads. Allocations and
+    // deallocations of other threads may lag behind until these threads
+    // exchange nodes with the global list or exit.
+    static pool_stats stats()
+    {
+        return detail::node_pool<T>::stats();
+    }
+
+    // Returns free nodes of the calling thread and of the global list to
+    // the system. Nodes cached by other threads are kept.
+    static void release()
+    {
+        detail::node_pool<T>::release();
+    }
+};
+
+template <typename T, typename U>
+bool operator==(pool_allocator<T> const&, pool_allocator<U> const&) noexcept
+{
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(pool_allocator<T> const&, pool_allocator<U> const&) noexcept
+{
+    return false;
+}
+
+template <typename T>
+using pooled_recursive_wrapper = recursive_wrapper<T, pool_allocator<T>>;
+
+} // namespace util
+} // namespace mapbox
+
+#endif // MAPBOX_UTIL_POOL_ALLOCATOR_HPP
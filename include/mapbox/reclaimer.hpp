@@ -0,0 +1,209 @@
+#ifndef MAPBOX_UTIL_RECLAIMER_HPP
+#define MAPBOX_UTIL_RECLAIMER_HPP
+
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <mapbox/variant.hpp>
+
+namespace mapbox {
+namespace util {
+
+// What reclaimer::retire() does when max_pending values are already waiting.
+enum class reclaimer_overflow
+{
+    destroy, // destroy the value on the calling thread
+    wait     // wait until the reclaimer thread has caught up
+};
+
+struct reclaimer_options
+{
+    std::size_t max_pending = 64; // values (not nodes) waiting to be destroyed
+    std::size_t batch_size = 8;   // values (not nodes) destroyed per turn of the reclaimer thread
+    reclaimer_overflow overflow = reclaimer_overflow::destroy;
+};
+
+struct reclaimer_stats
+{
+    std::size_t retired;          // values handed to the reclaimer thread
+    std::size_t reclaimed;        // values it has destroyed
+    std::size_t destroyed_inline; // values destroyed by retire() because the queue was full
+    std::size_t batches;          // turns of the reclaimer thread
+    std::size_t pending;          // values waiting to be destroyed
+};
+
+/**
+ * Destroys values on a background thread, so that dropping a large tree of
+ * recursive_wrapper nodes does not stall the thread that drops it.
+ * retire() moves the value into the queue, which takes constant time for a
+ * variant holding a recursive_wrapper, as the move steals the node.
+ *
+ * The reclaimer thread destroys the values in batches of batch_size,
+ * taking the lock once per batch. At most max_pending values wait at a
+ * time; beyond that, retire() applies the overflow policy, so a producer
+ * outrunning the reclaimer cannot pile up unbounded garbage.
+ *
+ * Both limits count retired values, not the nodes they own. A value is
+ * destroyed in one uninterrupted call to its destructor, so a tree of a
+ * million nodes is one entry of a batch, and a few such trees stay within
+ * max_pending however much memory they hold. Retire the subtrees of a huge
+ * tree separately to spread its destruction over several batches.
+ *
+ * The destructor waits until all retired values are destroyed. Values must
+ * not use allocators that are tied to the retiring thread.
+ *
+ * max_pending and batch_size must be at least 1. The constructor throws
+ * std::invalid_argument otherwise, or without exceptions raises them to 1.
+ */
+class reclaimer
+{
+public:
+    explicit reclaimer(reclaimer_options const& options = reclaimer_options())
+        : options_(checked(options)),
+          thread_(&reclaimer::run, this)
+    {
+    }
+
+    reclaimer(reclaimer const&) = delete;
+    reclaimer& operator=(reclaimer const&) = delete;
+
+    ~reclaimer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        work_.notify_one();
+        thread_.join();
+    }
+
+    /**
+     * Hands value over to the reclaimer thread. Pass it with std::move, or
+     * it is copied first.
+     */
+    template <typename T>
+    void retire(T value)
+    {
+        std::unique_ptr<retired_base> item(new retired<T>(std::move(value)));
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (pending_.size() >= options_.max_pending)
+        {
+            if (options_.overflow == reclaimer_overflow::destroy)
+            {
+                ++destroyed_inline_;
+                lock.unlock();
+                return; // item goes out of scope here
+            }
+            room_.wait(lock, [this] { return pending_.size() < options_.max_pending; });
+        }
+        pending_.push_back(std::move(item));
+        ++retired_;
+        lock.unlock();
+        work_.notify_one();
+    }
+
+    // Waits until all values retired so far are destroyed.
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        room_.wait(lock, [this] { return pending_.empty() && in_progress_ == 0; });
+    }
+
+    reclaimer_stats stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reclaimer_stats s;
+        s.retired = retired_;
+        s.reclaimed = reclaimed_;
+        s.destroyed_inline = destroyed_inline_;
+        s.batches = batches_;
+        s.pending = pending_.size();
+        return s;
+    }
+
+private:
+    static reclaimer_options checked(reclaimer_options options)
+    {
+        if (options.max_pending == 0 || options.batch_size == 0)
+        {
+#ifdef HAS_EXCEPTIONS
+            throw std::invalid_argument("reclaimer: max_pending and batch_size must be at least 1");
+#else
+            assert(false);
+            options.max_pending = options.max_pending == 0 ? 1 : options.max_pending;
+            options.batch_size = options.batch_size == 0 ? 1 : options.batch_size;
+#endif
+        }
+        return options;
+    }
+
+    struct retired_base
+    {
+        virtual ~retired_base() = default;
+    };
+
+    template <typename T>
+    struct retired : retired_base
+    {
+        T value;
+
+        explicit retired(T&& v)
+            : value(std::move(v)) {}
+    };
+
+    void run()
+    {
+        std::vector<std::unique_ptr<retired_base>> batch;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;)
+        {
+            work_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+            if (pending_.empty())
+            {
+                return; // stopped, and everything is destroyed
+            }
+            std::size_t const count = pending_.size() < options_.batch_size ? pending_.size() : options_.batch_size;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                batch.push_back(std::move(pending_.front()));
+                pending_.pop_front();
+            }
+            in_progress_ = count;
+            lock.unlock();
+            room_.notify_all();
+            batch.clear();
+            lock.lock();
+            in_progress_ = 0;
+            reclaimed_ += count;
+            ++batches_;
+            room_.notify_all();
+        }
+    }
+
+    reclaimer_options const options_;
+    mutable std::mutex mutex_;
+    std::condition_variable work_; // signals the reclaimer thread
+    std::condition_variable room_; // signals retire() and flush()
+    std::deque<std::unique_ptr<retired_base>> pending_;
+    std::size_t in_progress_ = 0;
+    bool stop_ = false;
+    std::size_t retired_ = 0;
+    std::size_t reclaimed_ = 0;
+    std::size_t destroyed_inline_ = 0;
+    std::size_t batches_ = 0;
+    std::thread thread_; // last, so that it starts once everything else is set up
+};
+
+} // namespace util
+} // namespace mapbox
+
+#endif // MAPBOX_UTIL_RECLAIMER_HPP
@@ -13,54 +13,492 @@
 // http://www.boost.org/LICENSE_1_0.txt)
 
 #include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
 #include <utility>
 
+// Number of nested node destructions after which recursive_wrapper stops
+// recursing and destroys the remaining nodes from a work list.
+#ifndef MAPBOX_VARIANT_TEARDOWN_DEPTH
+#define MAPBOX_VARIANT_TEARDOWN_DEPTH 64
+#endif
+
+// Define to count the nodes recursive_wrapper allocates, see
+// allocation_tracker.hpp. It changes the definition of recursive_wrapper,
+// so it must be defined the same way in all translation units.
+#ifdef MAPBOX_VARIANT_TRACK_ALLOCATIONS
+#include <mapbox/allocation_tracker.hpp>
+#define MAPBOX_VARIANT_TRACK_ALLOCATION(T) ::mapbox::util::detail::track_allocation<T>()
+#define MAPBOX_VARIANT_TRACK_DEALLOCATION(T) ::mapbox::util::detail::track_deallocation<T>()
+#else
+#define MAPBOX_VARIANT_TRACK_ALLOCATION(T)
+#define MAPBOX_VARIANT_TRACK_DEALLOCATION(T)
+#endif
+
 namespace mapbox {
 namespace util {
 
-template <typename T>
-class recursive_wrapper
+namespace detail {
+
+// Destroys heap nodes of recursive variants without recursing too deep,
+// for the node types opted in with bounded_teardown. Nodes are destroyed
+// right away until MAPBOX_VARIANT_TEARDOWN_DEPTH nested destructions are
+// running on the thread. The node at that depth then sets up a work list:
+// nodes released while it is being destroyed, such as its children, are
+// put on the list instead of being destroyed right away, and are destroyed
+// one after the other once it is gone. Tearing down a tree takes a bounded
+// amount of stack, however deep the tree is.
+class teardown
 {
+public:
+    using dispose_function = void (*)(void*);
+
+    static void dispose(void* p, dispose_function f) noexcept
+    {
+        context& c = current();
+        if (c.depth < max_depth)
+        {
+            ++c.depth;
+            f(p);
+            --c.depth;
+            return;
+        }
+        if (c.list)
+        {
+            if (!c.list->push(p, f))
+            {
+                f(p); // out of memory, destroy it on the stack
+            }
+            return;
+        }
+        teardown list;
+        c.list = &list;
+        f(p);
+        while (list.size_ > 0)
+        {
+            entry const e = list.pop();
+            e.f(e.p);
+        }
+        c.list = nullptr;
+    }
 
-    T* p_;
+private:
+    struct entry
+    {
+        void* p;
+        dispose_function f;
+    };
+
+    static constexpr std::size_t inline_capacity = 16;
+
+    entry inline_[inline_capacity];
+    entry* entries_ = inline_;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = inline_capacity;
 
-    void assign(T const& rhs)
+    teardown() = default;
+    teardown(teardown const&) = delete;
+    teardown& operator=(teardown const&) = delete;
+
+    ~teardown()
     {
-        this->get() = rhs;
+        if (entries_ != inline_)
+        {
+            std::free(entries_);
+        }
     }
 
+    struct context
+    {
+        unsigned depth;
+        teardown* list;
+    };
+
+    static constexpr unsigned max_depth = MAPBOX_VARIANT_TEARDOWN_DEPTH;
+
+    static context& current() noexcept
+    {
+        static thread_local context c{0, nullptr};
+        return c;
+    }
+
+    bool push(void* p, dispose_function f) noexcept
+    {
+        if (size_ == capacity_ && !grow())
+        {
+            return false;
+        }
+        entries_[size_++] = entry{p, f};
+        return true;
+    }
+
+    entry pop() noexcept
+    {
+        return entries_[--size_];
+    }
+
+    bool grow() noexcept
+    {
+        std::size_t const capacity = capacity_ * 2;
+        void* entries = entries_ == inline_
+            ? std::malloc(capacity * sizeof(entry))
+            : std::realloc(entries_, capacity * sizeof(entry));
+        if (!entries)
+        {
+            return false;
+        }
+        if (entries_ == inline_)
+        {
+            std::memcpy(entries, inline_, size_ * sizeof(entry));
+        }
+        entries_ = static_cast<entry*>(entries);
+        capacity_ = capacity;
+        return true;
+    }
+};
+
+} // namespace detail
+
+/**
+ * Specialize to derive from std::true_type to destroy trees of
+ * recursive_wrapper<T> and shared_recursive_wrapper<T> with a bounded
+ * amount of stack (see detail::teardown), however deep they are.
+ *
+ * It is off by default, and such trees are destroyed recursively. Turning
+ * it on keeps deeply nested nodes on a thread local work list, which
+ * changes the order in which they are destroyed and may allocate.
+ */
+template <typename T>
+struct bounded_teardown : std::false_type
+{
+};
+
+/**
+ * Specialize to derive from std::true_type to let default constructed
+ * recursive_wrapper<T> values start out empty instead of allocating a T.
+ *
+ * It is off by default. Turning it on requires T to be default
+ * constructible and changes what an empty wrapper does: const access sees
+ * a shared value initialized T, non-const access allocates a value
+ * initialized T of its own and may throw std::bad_alloc, and get_pointer()
+ * returns null until then.
+ */
+template <typename T>
+struct deferred_allocation : std::false_type
+{
+};
+
+/**
+ * Holds a T on the heap, so that a variant can contain itself indirectly.
+ *
+ * The value is allocated with Alloc, which makes it possible to keep whole
+ * trees in an arena or a std::pmr::memory_resource. The allocator is fixed
+ * when the wrapper is constructed, except that a move constructed wrapper
+ * takes over the allocator together with the value. Stateless allocators
+ * take up no space.
+ *
+ * The allocator is not passed on to the wrappers inside T: a tree lives in
+ * an arena only if each of its wrappers is constructed with it. Destroying
+ * a tree still runs the destructor of every node; an arena makes freeing
+ * their memory cheap, but does not skip the walk over the tree.
+ *
+ * If bounded_teardown<T> is true and the allocator is stateless,
+ * destroying a tree of wrappers recurses only to a bounded depth, so
+ * arbitrarily deep trees can be destroyed (see detail::teardown). Other
+ * trees are destroyed recursively.
+ */
+template <typename T, typename Alloc = std::allocator<T>>
+class recursive_wrapper
+{
 public:
     using type = T;
+    using allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+
+private:
+    using traits = std::allocator_traits<allocator_type>;
+
+    static_assert(std::is_same<typename traits::pointer, T*>::value,
+                  "recursive_wrapper requires an allocator using plain pointers.");
+
+    // Stateless allocators are always equal, as std::allocator_traits
+    // defines is_always_equal in C++17.
+    using allocator_always_equal = std::is_empty<allocator_type>;
+
+    // The allocator is a base, so that an empty one adds nothing to the size.
+    struct holder : allocator_type
+    {
+        T* p_;
+
+        holder(allocator_type const& alloc, T* p) noexcept
+            : allocator_type(alloc), p_(p) {}
+
+        holder(allocator_type&& alloc, T* p) noexcept
+            : allocator_type(std::move(alloc)), p_(p) {}
+    };
+
+    holder h_;
+
+    allocator_type& alloc() noexcept { return h_; }
+
+    allocator_type const& alloc() const noexcept { return h_; }
+
+    // Gives the memory back if the constructor of T throws.
+    struct deallocate_guard
+    {
+        allocator_type& alloc_;
+        T* p_;
+
+        ~deallocate_guard()
+        {
+            if (p_)
+            {
+                traits::deallocate(alloc_, p_, 1);
+            }
+        }
+    };
+
+    // Default initializes the value, as new T does.
+    T* create_default(std::false_type)
+    {
+        deallocate_guard guard{alloc(), traits::allocate(alloc(), 1)};
+        ::new (static_cast<void*>(guard.p_)) T;
+        T* p = guard.p_;
+        guard.p_ = nullptr;
+        MAPBOX_VARIANT_TRACK_ALLOCATION(T);
+        return p;
+    }
+
+    T* create_default(std::true_type) noexcept
+    {
+        return nullptr;
+    }
+
+    template <typename... Args>
+    T* create(Args&&... args)
+    {
+        deallocate_guard guard{alloc(), traits::allocate(alloc(), 1)};
+        traits::construct(alloc(), guard.p_, std::forward<Args>(args)...);
+        T* p = guard.p_;
+        guard.p_ = nullptr;
+        MAPBOX_VARIANT_TRACK_ALLOCATION(T);
+        return p;
+    }
+
+    // Nodes can be destroyed through detail::teardown when T opts in and any
+    // allocator can free them, as a default constructed one then stands in
+    // for the allocator of the wrapper.
+    using deferred_destruction = std::integral_constant<bool, bounded_teardown<T>::value &&
+                                                                  allocator_always_equal::value &&
+                                                                  std::is_default_constructible<allocator_type>::value>;
+
+    static void dispose(void* p) noexcept
+    {
+        MAPBOX_VARIANT_TRACK_DEALLOCATION(T);
+        allocator_type a;
+        traits::destroy(a, static_cast<T*>(p));
+        traits::deallocate(a, static_cast<T*>(p), 1);
+    }
+
+    void destroy(T* p, std::true_type) noexcept
+    {
+        detail::teardown::dispose(p, &dispose);
+    }
+
+    void destroy(T* p, std::false_type) noexcept
+    {
+        MAPBOX_VARIANT_TRACK_DEALLOCATION(T);
+        traits::destroy(alloc(), p);
+        traits::deallocate(alloc(), p, 1);
+    }
 
+    void reset() noexcept
+    {
+        if (h_.p_)
+        {
+            T* p = h_.p_;
+            h_.p_ = nullptr;
+            destroy(p, deferred_destruction());
+        }
+    }
+
+    template <typename U>
+    void assign(U&& rhs)
+    {
+        if (h_.p_)
+        {
+            *h_.p_ = std::forward<U>(rhs);
+        }
+        else
+        {
+            h_.p_ = create(std::forward<U>(rhs));
+        }
+    }
+
+    void swap_allocators(recursive_wrapper& other, std::true_type) noexcept
+    {
+        using std::swap;
+        swap(alloc(), other.alloc());
+    }
+
+    void swap_allocators(recursive_wrapper&, std::false_type) noexcept {}
+
+    // The old value has to be freed with the old allocator before the new
+    // one takes over, unless the two can free each other's memory.
+    void copy_allocator(recursive_wrapper const& rhs, std::true_type)
+    {
+        if (!allocator_always_equal::value && get_allocator() != rhs.get_allocator())
+        {
+            reset();
+        }
+        alloc() = rhs.alloc();
+    }
+
+    void copy_allocator(recursive_wrapper const&, std::false_type) {}
+
+    void move_assign(recursive_wrapper& rhs, std::true_type) noexcept
+    {
+        swap_allocators(rhs, typename traits::propagate_on_container_move_assignment());
+        std::swap(h_.p_, rhs.h_.p_);
+    }
+
+    void move_assign(recursive_wrapper& rhs, std::false_type)
+    {
+        if (get_allocator() == rhs.get_allocator())
+        {
+            std::swap(h_.p_, rhs.h_.p_);
+        }
+        else if (rhs.h_.p_)
+        {
+            assign(std::move(*rhs.h_.p_));
+        }
+        else
+        {
+            reset();
+        }
+    }
+
+    T& get(std::true_type)
+    {
+        if (!h_.p_)
+        {
+            h_.p_ = create();
+        }
+        return *h_.p_;
+    }
+
+    T& get(std::false_type)
+    {
+        assert(h_.p_);
+        return *h_.p_;
+    }
+
+    T const& get(std::true_type) const
+    {
+        if (!h_.p_)
+        {
+            static T const default_value{};
+            return default_value;
+        }
+        return *h_.p_;
+    }
+
+    T const& get(std::false_type) const
+    {
+        assert(h_.p_);
+        return *h_.p_;
+    }
+
+public:
     /**
      * Default constructor default initializes the internally stored value.
      * For POD types this means nothing is done and the storage is
-     * uninitialized.
+     * uninitialized. If deferred_allocation<T> is true, nothing is
+     * allocated and the wrapper starts out empty instead.
      *
      * @throws std::bad_alloc if there is insufficient memory for an object
      *         of type T.
      * @throws any exception thrown by the default constructur of T.
      */
-    recursive_wrapper()
-        : p_(new T){}
+    recursive_wrapper() noexcept(deferred_allocation<T>::value &&
+                                 std::is_nothrow_default_constructible<allocator_type>::value)
+        : h_(allocator_type(), nullptr)
+    {
+        h_.p_ = create_default(deferred_allocation<T>());
+    }
 
-    ~recursive_wrapper() noexcept { delete p_; }
+    recursive_wrapper(std::allocator_arg_t, allocator_type const& a) noexcept(deferred_allocation<T>::value)
+        : h_(a, nullptr)
+    {
+        h_.p_ = create_default(deferred_allocation<T>());
+    }
+
+    ~recursive_wrapper() noexcept { reset(); }
 
     recursive_wrapper(recursive_wrapper const& operand)
-        : p_(new T(operand.get())) {}
+        : h_(traits::select_on_container_copy_construction(operand.get_allocator()), nullptr)
+    {
+        if (operand.h_.p_)
+        {
+            h_.p_ = create(*operand.h_.p_);
+        }
+    }
 
     recursive_wrapper(T const& operand)
-        : p_(new T(operand)) {}
+        : h_(allocator_type(), nullptr)
+    {
+        h_.p_ = create(operand);
+    }
 
-    recursive_wrapper(recursive_wrapper&& operand)
-        : p_(new T(std::move(operand.get()))) {}
+    recursive_wrapper(std::allocator_arg_t, allocator_type const& a, T const& operand)
+        : h_(a, nullptr)
+    {
+        h_.p_ = create(operand);
+    }
+
+    /**
+     * Move constructor takes over the stored value and the allocator
+     * without allocating. The moved-from wrapper is left empty. Copying an
+     * empty wrapper yields another empty wrapper.
+     */
+    recursive_wrapper(recursive_wrapper&& operand) noexcept
+        : h_(std::move(operand.alloc()), operand.h_.p_)
+    {
+        operand.h_.p_ = nullptr;
+    }
 
     recursive_wrapper(T&& operand)
-        : p_(new T(std::move(operand))) {}
+        : h_(allocator_type(), nullptr)
+    {
+        h_.p_ = create(std::move(operand));
+    }
 
+    recursive_wrapper(std::allocator_arg_t, allocator_type const& a, T&& operand)
+        : h_(a, nullptr)
+    {
+        h_.p_ = create(std::move(operand));
+    }
+
+    /**
+     * Copy assignment copies the value into the memory of the target. If
+     * the allocators propagate on copy assignment, the allocator of rhs is
+     * copied first, and the old value is freed with the old allocator if
+     * the two are not equal.
+     */
     inline recursive_wrapper& operator=(recursive_wrapper const& rhs)
     {
-        assign(rhs.get());
+        copy_allocator(rhs, typename traits::propagate_on_container_copy_assignment());
+        if (rhs.h_.p_)
+        {
+            assign(*rhs.h_.p_);
+        }
+        else
+        {
+            reset();
+        }
         return *this;
     }
 
@@ -70,40 +508,65 @@ public:
         return *this;
     }
 
+    /**
+     * Exchanges the values, and the allocators if they propagate on swap.
+     * As for standard containers, allocators that do not propagate must be
+     * equal.
+     */
     inline void swap(recursive_wrapper& operand) noexcept
     {
-        T* temp = operand.p_;
-        operand.p_ = p_;
-        p_ = temp;
+        assert(allocator_always_equal::value ||
+               traits::propagate_on_container_swap::value ||
+               get_allocator() == operand.get_allocator());
+        swap_allocators(operand, typename traits::propagate_on_container_swap());
+        std::swap(h_.p_, operand.h_.p_);
     }
 
-    recursive_wrapper& operator=(recursive_wrapper&& rhs) noexcept
+    /**
+     * Move assignment exchanges the values if the allocators are equal or
+     * propagate on move assignment, and moves the value across otherwise.
+     */
+    recursive_wrapper& operator=(recursive_wrapper&& rhs) noexcept(allocator_always_equal::value ||
+                                                                  traits::propagate_on_container_move_assignment::value)
     {
-        swap(rhs);
+        move_assign(rhs, std::integral_constant<bool, allocator_always_equal::value ||
+                                                          traits::propagate_on_container_move_assignment::value>());
         return *this;
     }
 
     recursive_wrapper& operator=(T&& rhs)
     {
-        get() = std::move(rhs);
+        assign(std::move(rhs));
         return *this;
     }
 
+    /**
+     * Returns the stored value. If deferred_allocation<T> is true and the
+     * wrapper is empty, a value initialized T is allocated first.
+     */
     T& get()
     {
-        assert(p_);
-        return *get_pointer();
+        return get(deferred_allocation<T>());
     }
 
+    /**
+     * Returns the stored value. If deferred_allocation<T> is true and the
+     * wrapper is empty, returns a shared value initialized T.
+     */
     T const& get() const
     {
-        assert(p_);
-        return *get_pointer();
+        return get(deferred_allocation<T>());
     }
 
-    T* get_pointer() { return p_; }
+    /**
+     * Returns the pointer to the stored value, which is null only if the
+     * wrapper is empty.
+     */
+    T* get_pointer() { return h_.p_; }
 
-    const T* get_pointer() const { return p_; }
+    const T* get_pointer() const { return h_.p_; }
+
+    allocator_type get_allocator() const { return h_; }
 
     operator T const&() const { return this->get(); }
 
@@ -111,8 +574,8 @@ public:
 
 }; // class recursive_wrapper
 
-template <typename T>
-inline void swap(recursive_wrapper<T>& lhs, recursive_wrapper<T>& rhs) noexcept
+template <typename T, typename Alloc>
+inline void swap(recursive_wrapper<T, Alloc>& lhs, recursive_wrapper<T, Alloc>& rhs) noexcept
 {
     lhs.swap(rhs);
 }
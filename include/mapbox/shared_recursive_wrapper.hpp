@@ -0,0 +1,244 @@
+#ifndef MAPBOX_UTIL_SHARED_RECURSIVE_WRAPPER_HPP
+#define MAPBOX_UTIL_SHARED_RECURSIVE_WRAPPER_HPP
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include <mapbox/recursive_wrapper.hpp>
+
+namespace mapbox {
+namespace util {
+
+/**
+ * Holds a T on the heap like recursive_wrapper, but copies share the value
+ * instead of copying it. The value is copied when it is about to be
+ * modified through a wrapper that shares it (copy on write), so copying a
+ * large tree is cheap and modifying a copy does not affect the original.
+ * The value is unshared only when get() is called, so a reference returned
+ * by the non-const get() must not be used once the wrapper has been
+ * copied: writes through it would show up in the copy. Call get() again
+ * after copying instead.
+ *
+ * The reference count is atomic, so copies of one value can be used and
+ * released on different threads. Each wrapper object itself must not be
+ * accessed by several threads at the same time if one of them modifies it.
+ * Like recursive_wrapper, it destroys deep trees with a bounded amount of
+ * stack if bounded_teardown<T> is true.
+ */
+template <typename T>
+class shared_recursive_wrapper
+{
+    struct node
+    {
+        std::atomic<std::size_t> count;
+        T value;
+
+        template <typename... Args>
+        explicit node(Args&&... args)
+            : count(1), value(std::forward<Args>(args)...) {}
+    };
+
+    node* p_;
+
+    static void dispose(void* p) noexcept
+    {
+        delete static_cast<node*>(p);
+    }
+
+    void release() noexcept
+    {
+        node* n = p_;
+        p_ = nullptr;
+        if (n && n->count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            destroy(n, bounded_teardown<T>());
+        }
+    }
+
+    static void destroy(node* n, std::true_type) noexcept
+    {
+        detail::teardown::dispose(n, &dispose);
+    }
+
+    static void destroy(node* n, std::false_type) noexcept
+    {
+        delete n;
+    }
+
+    // Makes sure this wrapper is the only owner of its value.
+    T& unshare(std::true_type)
+    {
+        if (!p_)
+        {
+            p_ = new node();
+            return p_->value;
+        }
+        return unshare(std::false_type());
+    }
+
+    T& unshare(std::false_type)
+    {
+        assert(p_);
+        if (p_->count.load(std::memory_order_acquire) != 1)
+        {
+            node* copy = new node(p_->value);
+            release();
+            p_ = copy;
+        }
+        return p_->value;
+    }
+
+    T const& get(std::true_type) const
+    {
+        if (!p_)
+        {
+            static T const default_value{};
+            return default_value;
+        }
+        return p_->value;
+    }
+
+    T const& get(std::false_type) const
+    {
+        assert(p_);
+        return p_->value;
+    }
+
+    template <typename U>
+    void assign(U&& rhs)
+    {
+        if (p_ && p_->count.load(std::memory_order_acquire) == 1)
+        {
+            p_->value = std::forward<U>(rhs);
+        }
+        else
+        {
+            node* n = new node(std::forward<U>(rhs));
+            release();
+            p_ = n;
+        }
+    }
+
+public:
+    using type = T;
+
+    /**
+     * Default constructor does not allocate. The wrapper starts out empty
+     * and behaves as if it held a value initialized T, like a
+     * recursive_wrapper with deferred_allocation.
+     */
+    shared_recursive_wrapper() noexcept
+        : p_(nullptr) {}
+
+    ~shared_recursive_wrapper() noexcept { release(); }
+
+    /**
+     * Copy constructor shares the value of operand.
+     */
+    shared_recursive_wrapper(shared_recursive_wrapper const& operand) noexcept
+        : p_(operand.p_)
+    {
+        if (p_)
+        {
+            p_->count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    shared_recursive_wrapper(T const& operand)
+        : p_(new node(operand)) {}
+
+    shared_recursive_wrapper(shared_recursive_wrapper&& operand) noexcept
+        : p_(operand.p_)
+    {
+        operand.p_ = nullptr;
+    }
+
+    shared_recursive_wrapper(T&& operand)
+        : p_(new node(std::move(operand))) {}
+
+    shared_recursive_wrapper& operator=(shared_recursive_wrapper const& rhs) noexcept
+    {
+        shared_recursive_wrapper(rhs).swap(*this);
+        return *this;
+    }
+
+    shared_recursive_wrapper& operator=(shared_recursive_wrapper&& rhs) noexcept
+    {
+        swap(rhs);
+        return *this;
+    }
+
+    shared_recursive_wrapper& operator=(T const& rhs)
+    {
+        assign(rhs);
+        return *this;
+    }
+
+    shared_recursive_wrapper& operator=(T&& rhs)
+    {
+        assign(std::move(rhs));
+        return *this;
+    }
+
+    void swap(shared_recursive_wrapper& operand) noexcept
+    {
+        std::swap(p_, operand.p_);
+    }
+
+    /**
+     * Returns the value for modification, copying it first if it is
+     * shared with other wrappers, or allocating it if the wrapper is empty.
+     */
+    T& get()
+    {
+        return unshare(std::is_default_constructible<T>());
+    }
+
+    /**
+     * Returns the value, which may be shared with other wrappers, or a
+     * shared value initialized T if the wrapper is empty.
+     */
+    T const& get() const
+    {
+        return get(std::is_default_constructible<T>());
+    }
+
+    /**
+     * Returns the pointer to the value, which is null if the wrapper is
+     * empty. The non-const overload unshares the value first.
+     */
+    T* get_pointer()
+    {
+        return p_ ? &get() : nullptr;
+    }
+
+    const T* get_pointer() const { return p_ ? &p_->value : nullptr; }
+
+    // Number of wrappers sharing the value, zero if the wrapper is empty.
+    std::size_t use_count() const noexcept
+    {
+        return p_ ? p_->count.load(std::memory_order_relaxed) : 0;
+    }
+
+    // Heap memory taken by each value, including its reference count.
+    static constexpr std::size_t node_size() noexcept { return sizeof(node); }
+
+    operator T const&() const { return this->get(); }
+
+    operator T&() { return this->get(); }
+
+}; // class shared_recursive_wrapper
+
+template <typename T>
+inline void swap(shared_recursive_wrapper<T>& lhs, shared_recursive_wrapper<T>& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+} // namespace util
+} // namespace mapbox
+
+#endif // MAPBOX_UTIL_SHARED_RECURSIVE_WRAPPER_HPP
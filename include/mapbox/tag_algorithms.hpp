@@ -0,0 +1,493 @@
+#ifndef MAPBOX_UTIL_TAG_ALGORITHMS_HPP
+#define MAPBOX_UTIL_TAG_ALGORITHMS_HPP
+
+// Queries over the types of many variants at once: how many hold a T, where
+// the first one holding a T is, a bitmask of those holding a T, and
+// permutations grouping them by type.
+//
+// They work on a column of one byte tags, the zero based index of the
+// alternative of each value, such as variant_vector::tags(). For a
+// std::vector of variants the tags are first gathered into blocks of
+// tag_block_size. The tags are compared 64 at a time with AVX2, SSE2 or
+// NEON, whichever the compiler targets, or with plain loops otherwise.
+// Defining MAPBOX_VARIANT_NO_SIMD forces the plain loops.
+//
+// The functions that depend on the instruction set are declared in an
+// inline namespace named after it, so translation units built with
+// different -march flags call distinct functions instead of linking
+// different definitions of the same inline function.
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <mapbox/variant.hpp>
+#include <mapbox/variant_vector.hpp>
+
+#if !defined(MAPBOX_VARIANT_NO_SIMD)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MAPBOX_VARIANT_TAG_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MAPBOX_VARIANT_TAG_SIMD_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define MAPBOX_VARIANT_TAG_SIMD_NEON
+#endif
+#endif
+
+#if defined(MAPBOX_VARIANT_TAG_SIMD_AVX2)
+#define MAPBOX_VARIANT_TAG_SIMD_NAMESPACE tag_simd_avx2
+#elif defined(MAPBOX_VARIANT_TAG_SIMD_SSE2)
+#define MAPBOX_VARIANT_TAG_SIMD_NAMESPACE tag_simd_sse2
+#elif defined(MAPBOX_VARIANT_TAG_SIMD_NEON)
+#define MAPBOX_VARIANT_TAG_SIMD_NAMESPACE tag_simd_neon
+#else
+#define MAPBOX_VARIANT_TAG_SIMD_NAMESPACE tag_simd_scalar
+#endif
+
+namespace mapbox {
+namespace util {
+
+// A bitmask over a column of tags: bit i % 64 of word i / 64 is set if
+// tag i matched.
+using tag_bitmask = std::vector<std::uint64_t>;
+
+// Positions into a column of tags. Permutations are only made of columns of
+// at most 2^32 - 1 tags.
+using tag_permutation = std::vector<std::uint32_t>;
+
+// Number of tags a std::vector of variants is gathered into at a time.
+constexpr std::size_t tag_block_size = 4096;
+
+inline namespace MAPBOX_VARIANT_TAG_SIMD_NAMESPACE {
+
+// Name of the instruction set the tags are compared with.
+inline char const* tag_simd_instruction_set() noexcept
+{
+#if defined(MAPBOX_VARIANT_TAG_SIMD_AVX2)
+    return "avx2";
+#elif defined(MAPBOX_VARIANT_TAG_SIMD_SSE2)
+    return "sse2";
+#elif defined(MAPBOX_VARIANT_TAG_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace MAPBOX_VARIANT_TAG_SIMD_NAMESPACE
+
+namespace detail {
+
+// The zero based index of the alternative of a value, as stored by
+// variant_vector.
+using tag_type = std::uint8_t;
+
+inline unsigned popcount(std::uint64_t bits) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_popcountll(bits));
+#else
+    unsigned count = 0;
+    for (; bits != 0; bits &= bits - 1)
+    {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// Position of the lowest set bit, bits must not be zero.
+inline unsigned lowest_bit(std::uint64_t bits) noexcept
+{
+    assert(bits != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(bits));
+#else
+    unsigned position = 0;
+    for (; (bits & 1) == 0; bits >>= 1)
+    {
+        ++position;
+    }
+    return position;
+#endif
+}
+
+inline namespace MAPBOX_VARIANT_TAG_SIMD_NAMESPACE {
+
+// Bit i is set if tags[i] == tag, for the 64 tags starting at tags.
+inline std::uint64_t match_64(tag_type const* tags, tag_type tag) noexcept
+{
+#if defined(MAPBOX_VARIANT_TAG_SIMD_AVX2)
+    __m256i const needle = _mm256_set1_epi8(static_cast<char>(tag));
+    __m256i const lo = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(tags));
+    __m256i const hi = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(tags + 32));
+    std::uint64_t const lo_bits = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, needle)));
+    std::uint64_t const hi_bits = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, needle)));
+    return lo_bits | (hi_bits << 32);
+#elif defined(MAPBOX_VARIANT_TAG_SIMD_SSE2)
+    __m128i const needle = _mm_set1_epi8(static_cast<char>(tag));
+    std::uint64_t bits = 0;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        __m128i const block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(tags + 16 * i));
+        std::uint64_t const block_bits = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+        bits |= block_bits << (16 * i);
+    }
+    return bits;
+#elif defined(MAPBOX_VARIANT_TAG_SIMD_NEON)
+    // NEON has no movemask: weight each matching byte by its bit and add
+    // up the bytes of each half.
+    static const std::uint8_t weights_data[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t const weights = vld1q_u8(weights_data);
+    uint8x16_t const needle = vdupq_n_u8(tag);
+    std::uint64_t bits = 0;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        uint8x16_t const matched = vandq_u8(vceqq_u8(vld1q_u8(tags + 16 * i), needle), weights);
+        std::uint64_t const block_bits = static_cast<std::uint64_t>(vaddv_u8(vget_low_u8(matched))) |
+                                         (static_cast<std::uint64_t>(vaddv_u8(vget_high_u8(matched))) << 8);
+        bits |= block_bits << (16 * i);
+    }
+    return bits;
+#else
+    std::uint64_t bits = 0;
+    for (unsigned i = 0; i < 64; ++i)
+    {
+        bits |= static_cast<std::uint64_t>(tags[i] == tag) << i;
+    }
+    return bits;
+#endif
+}
+
+// Like match_64, for the size < 64 tags starting at tags.
+inline std::uint64_t match_tail(tag_type const* tags, std::size_t size, tag_type tag) noexcept
+{
+    assert(size < 64);
+    std::uint64_t bits = 0;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        bits |= static_cast<std::uint64_t>(tags[i] == tag) << i;
+    }
+    return bits;
+}
+
+// Calls f(word_index, bits) with the match bits of each run of 64 tags.
+// Stops early when f returns false.
+template <typename F>
+bool for_each_match_word(tag_type const* tags, std::size_t size, tag_type tag, std::size_t first_word, F&& f)
+{
+    std::size_t const full = size / 64;
+    for (std::size_t w = 0; w < full; ++w)
+    {
+        if (!f(first_word + w, match_64(tags + 64 * w, tag)))
+        {
+            return false;
+        }
+    }
+    if (size % 64 != 0)
+    {
+        return f(first_word + full, match_tail(tags + 64 * full, size % 64, tag));
+    }
+    return true;
+}
+
+// Tags of a column that is stored as such.
+struct tag_span
+{
+    tag_type const* data;
+    std::size_t size;
+
+    std::size_t count() const noexcept { return size; }
+
+    // Calls f(tags, size, position) for each block of tags, stopping when it
+    // returns false. Every block but the last has a multiple of 64 tags.
+    template <typename F>
+    void for_each_block(F&& f) const
+    {
+        if (size != 0)
+        {
+            f(data, size, std::size_t(0));
+        }
+    }
+};
+
+// Tags of a std::vector of variants, gathered block by block.
+template <typename Variant>
+struct gathered_tags
+{
+    Variant const* data;
+    std::size_t size;
+
+    std::size_t count() const noexcept { return size; }
+
+    template <typename F>
+    void for_each_block(F&& f) const
+    {
+        tag_type block[tag_block_size];
+        for (std::size_t position = 0; position < size; position += tag_block_size)
+        {
+            std::size_t const n = size - position < tag_block_size ? size - position : tag_block_size;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                block[i] = static_cast<tag_type>(data[position + i].which());
+            }
+            if (!f(static_cast<tag_type const*>(block), n, position))
+            {
+                return;
+            }
+        }
+    }
+};
+
+template <typename Container>
+struct tag_source;
+
+template <typename... Types>
+struct tag_source<variant_vector<Types...>>
+{
+    template <typename T>
+    using alternative = alternative_of<T, Types...>;
+
+    static constexpr std::size_t alternatives = sizeof...(Types);
+
+    static tag_span tags(variant_vector<Types...> const& v) noexcept
+    {
+        return tag_span{v.tags().data(), v.size()};
+    }
+};
+
+template <typename... Types, typename Alloc>
+struct tag_source<std::vector<variant<Types...>, Alloc>>
+{
+    static_assert(sizeof...(Types) <= 255, "The tags of a variant with more than 255 alternatives do not fit in a byte.");
+
+    template <typename T>
+    using alternative = alternative_of<T, Types...>;
+
+    static constexpr std::size_t alternatives = sizeof...(Types);
+
+    static gathered_tags<variant<Types...>> tags(std::vector<variant<Types...>, Alloc> const& v) noexcept
+    {
+        return gathered_tags<variant<Types...>>{v.data(), v.size()};
+    }
+};
+
+template <typename Source>
+std::size_t count_tag(Source const& source, tag_type tag)
+{
+    std::size_t count = 0;
+    source.for_each_block([&count, tag](tag_type const* tags, std::size_t size, std::size_t) {
+        for_each_match_word(tags, size, tag, 0, [&count](std::size_t, std::uint64_t bits) {
+            count += popcount(bits);
+            return true;
+        });
+        return true;
+    });
+    return count;
+}
+
+template <typename Source>
+std::size_t find_tag(Source const& source, tag_type tag)
+{
+    std::size_t found = source.count();
+    source.for_each_block([&found, tag](tag_type const* tags, std::size_t size, std::size_t position) {
+        return for_each_match_word(tags, size, tag, position / 64, [&found](std::size_t word, std::uint64_t bits) {
+            if (bits == 0)
+            {
+                return true;
+            }
+            found = 64 * word + lowest_bit(bits);
+            return false;
+        });
+    });
+    return found;
+}
+
+template <typename Source>
+tag_bitmask tag_mask(Source const& source, tag_type tag)
+{
+    tag_bitmask mask((source.count() + 63) / 64);
+    source.for_each_block([&mask, tag](tag_type const* tags, std::size_t size, std::size_t position) {
+        for_each_match_word(tags, size, tag, position / 64, [&mask](std::size_t word, std::uint64_t bits) {
+            mask[word] = bits;
+            return true;
+        });
+        return true;
+    });
+    return mask;
+}
+
+// Appends the positions of the set bits, or of the clear bits below size.
+inline void append_positions(tag_bitmask const& mask, std::size_t size, bool set, tag_permutation& positions)
+{
+    for (std::size_t word = 0; word < mask.size(); ++word)
+    {
+        std::uint64_t bits = set ? mask[word] : ~mask[word];
+        if (!set && word == mask.size() - 1 && size % 64 != 0)
+        {
+            bits &= (std::uint64_t(1) << (size % 64)) - 1;
+        }
+        for (; bits != 0; bits &= bits - 1)
+        {
+            positions.push_back(static_cast<std::uint32_t>(64 * word + lowest_bit(bits)));
+        }
+    }
+}
+
+// Whether the positions of count tags fit in a tag_permutation. Throws
+// std::length_error if they do not.
+inline bool check_permutation_size(std::size_t count)
+{
+    if (count > std::numeric_limits<std::uint32_t>::max())
+    {
+#ifdef HAS_EXCEPTIONS
+        throw std::length_error("tag_permutation: too many tags");
+#else
+        assert(false);
+        return false;
+#endif
+    }
+    return true;
+}
+
+// Returns an empty permutation, without exceptions, if the positions do not
+// fit.
+template <typename Source>
+tag_permutation stable_partition_tag(Source const& source, tag_type tag)
+{
+    if (!check_permutation_size(source.count()))
+    {
+        return tag_permutation();
+    }
+    tag_bitmask const mask = tag_mask(source, tag);
+    tag_permutation positions;
+    positions.reserve(source.count());
+    append_positions(mask, source.count(), true, positions);
+    append_positions(mask, source.count(), false, positions);
+    return positions;
+}
+
+// A counting sort of the positions by tag. Fails as above.
+template <typename Source>
+tag_permutation group_by_tag(Source const& source)
+{
+    if (!check_permutation_size(source.count()))
+    {
+        return tag_permutation();
+    }
+    std::vector<std::size_t> starts(257, 0);
+    source.for_each_block([&starts](tag_type const* tags, std::size_t size, std::size_t) {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            ++starts[tags[i] + 1u];
+        }
+        return true;
+    });
+    for (std::size_t t = 1; t < starts.size(); ++t)
+    {
+        starts[t] += starts[t - 1];
+    }
+    tag_permutation positions(source.count());
+    source.for_each_block([&starts, &positions](tag_type const* tags, std::size_t size, std::size_t position) {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            positions[starts[tags[i]]++] = static_cast<std::uint32_t>(position + i);
+        }
+        return true;
+    });
+    return positions;
+}
+
+template <typename T, typename Container>
+tag_type tag_for() noexcept
+{
+    using alternative = typename tag_source<Container>::template alternative<T>;
+    static_assert(alternative::is_valid, "T is not an alternative of the container's variant.");
+    return static_cast<tag_type>(alternative::index);
+}
+
+} // namespace MAPBOX_VARIANT_TAG_SIMD_NAMESPACE
+} // namespace detail
+
+inline namespace MAPBOX_VARIANT_TAG_SIMD_NAMESPACE {
+
+// Number of tags equal to tag.
+inline std::size_t count_tag(std::uint8_t const* tags, std::size_t size, std::uint8_t tag)
+{
+    return detail::count_tag(detail::tag_span{tags, size}, tag);
+}
+
+// Position of the first tag equal to tag, or size if there is none.
+inline std::size_t find_tag(std::uint8_t const* tags, std::size_t size, std::uint8_t tag)
+{
+    return detail::find_tag(detail::tag_span{tags, size}, tag);
+}
+
+// Bitmask of the tags equal to tag.
+inline tag_bitmask tag_mask(std::uint8_t const* tags, std::size_t size, std::uint8_t tag)
+{
+    return detail::tag_mask(detail::tag_span{tags, size}, tag);
+}
+
+// The positions of the tags equal to tag, then those of the others, each in
+// increasing order. Throws std::length_error if size is 2^32 or more.
+inline tag_permutation stable_partition_tag(std::uint8_t const* tags, std::size_t size, std::uint8_t tag)
+{
+    return detail::stable_partition_tag(detail::tag_span{tags, size}, tag);
+}
+
+// The positions of all tags, ordered by tag and then by position. Throws
+// as above.
+inline tag_permutation group_by_tag(std::uint8_t const* tags, std::size_t size)
+{
+    return detail::group_by_tag(detail::tag_span{tags, size});
+}
+
+// The same queries over the values of a variant_vector or a std::vector of
+// variants, for the values holding a T:
+//
+//   count_alternative<std::string>(values); // how many are strings
+//   find_alternative<double>(values);       // position of the first double
+//
+// T can also be the type wrapped by an alternative.
+template <typename T, typename Container>
+std::size_t count_alternative(Container const& values)
+{
+    return detail::count_tag(detail::tag_source<Container>::tags(values), detail::tag_for<T, Container>());
+}
+
+template <typename T, typename Container>
+std::size_t find_alternative(Container const& values)
+{
+    return detail::find_tag(detail::tag_source<Container>::tags(values), detail::tag_for<T, Container>());
+}
+
+template <typename T, typename Container>
+tag_bitmask alternative_mask(Container const& values)
+{
+    return detail::tag_mask(detail::tag_source<Container>::tags(values), detail::tag_for<T, Container>());
+}
+
+template <typename T, typename Container>
+tag_permutation stable_partition_alternative(Container const& values)
+{
+    return detail::stable_partition_tag(detail::tag_source<Container>::tags(values), detail::tag_for<T, Container>());
+}
+
+template <typename Container>
+tag_permutation group_by_alternative(Container const& values)
+{
+    return detail::group_by_tag(detail::tag_source<Container>::tags(values));
+}
+
+} // namespace MAPBOX_VARIANT_TAG_SIMD_NAMESPACE
+} // namespace util
+} // namespace mapbox
+
+#endif // MAPBOX_UTIL_TAG_ALGORITHMS_HPP
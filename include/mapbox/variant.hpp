@@ -3,6 +3,7 @@
 
 #include <cassert>
 #include <cstddef>   // size_t
+#include <cstdint>   // uint8_t, uint16_t
 #include <new>       // operator new
 #include <stdexcept> // runtime_error
 #include <string>
@@ -12,8 +13,10 @@
 #include <utility>
 #include <functional>
 #include <limits>
+#include <memory>
 
 #include <mapbox/recursive_wrapper.hpp>
+#include <mapbox/shared_recursive_wrapper.hpp>
 #include <mapbox/variant_visitor.hpp>
 
 // clang-format off
@@ -52,6 +55,36 @@
 #define HAS_EXCEPTIONS
 #endif
 
+// Variants with more alternatives than these thresholds are visited, or
+// visited in pairs, through a jump table instead of a chain of type checks;
+// define them before including this header to override (the binary one
+// follows the unary one if only that is defined). They change the body of
+// every visit, so they must be defined the same way in all translation units.
+#ifndef MAPBOX_VARIANT_DISPATCH_TABLE_THRESHOLD
+#define MAPBOX_VARIANT_DISPATCH_TABLE_THRESHOLD 16
+#ifndef MAPBOX_VARIANT_BINARY_DISPATCH_TABLE_THRESHOLD
+#define MAPBOX_VARIANT_BINARY_DISPATCH_TABLE_THRESHOLD 8
+#endif
+#endif
+#ifndef MAPBOX_VARIANT_BINARY_DISPATCH_TABLE_THRESHOLD
+#define MAPBOX_VARIANT_BINARY_DISPATCH_TABLE_THRESHOLD MAPBOX_VARIANT_DISPATCH_TABLE_THRESHOLD
+#endif
+
+// Define to count visits, checked gets and assignments of every variant
+// type, see variant_instrumentation.hpp. It changes the definition of
+// variant, so it must be defined the same way in all translation units.
+#ifdef MAPBOX_VARIANT_INSTRUMENTATION
+#include <mapbox/variant_instrumentation.hpp>
+// The index arguments may contain commas, hence the variadic macros.
+#define MAPBOX_VARIANT_RECORD_VISIT(...) ::mapbox::util::detail::variant_probe<Types...>::instance().visited(__VA_ARGS__)
+#define MAPBOX_VARIANT_RECORD_GET(...) ::mapbox::util::detail::variant_probe<Types...>::instance().accessed(__VA_ARGS__)
+#define MAPBOX_VARIANT_RECORD_ASSIGN(old_index, ...) ::mapbox::util::detail::variant_probe<Types...>::instance().assigned(old_index, __VA_ARGS__)
+#else
+#define MAPBOX_VARIANT_RECORD_VISIT(...)
+#define MAPBOX_VARIANT_RECORD_GET(...)
+#define MAPBOX_VARIANT_RECORD_ASSIGN(old_index, ...)
+#endif
+
 #define VARIANT_MAJOR_VERSION 1
 #define VARIANT_MINOR_VERSION 1
 #define VARIANT_PATCH_VERSION 0
@@ -85,15 +118,7 @@ protected:
     ~static_visitor() {}
 };
 
-#if !defined(MAPBOX_VARIANT_MINIMIZE_SIZE)
 using type_index_t = unsigned int;
-#else
-#if defined(MAPBOX_VARIANT_OPTIMIZE_FOR_SPEED)
-using type_index_t = std::uint_fast8_t;
-#else
-using type_index_t = std::uint_least8_t;
-#endif
-#endif
 
 namespace detail {
 
@@ -116,6 +141,18 @@ struct direct_type<T>
     static constexpr type_index_t index = invalid_value;
 };
 
+// Number of times T occurs in Types.
+template <typename T, typename... Types>
+struct type_count : std::integral_constant<std::size_t, 0>
+{
+};
+
+template <typename T, typename First, typename... Types>
+struct type_count<T, First, Types...>
+    : std::integral_constant<std::size_t, std::is_same<T, First>::value + type_count<T, Types...>::value>
+{
+};
+
 #if __cpp_lib_logical_traits >= 201510L
 
 using std::conjunction;
@@ -149,6 +186,49 @@ struct disjunction<B1, Bs...> : std::conditional<B1::value, B1, disjunction<Bs..
 
 #endif
 
+// Whether W holds a T indirectly, as recursive_wrapper<T> does. Such
+// alternatives can be accessed as T through is<T>() and get<T>().
+template <typename W, typename T>
+struct is_wrapper_of : std::false_type {};
+
+template <typename T, typename Alloc>
+struct is_wrapper_of<recursive_wrapper<T, Alloc>, T> : std::true_type {};
+
+template <typename T>
+struct is_wrapper_of<shared_recursive_wrapper<T>, T> : std::true_type {};
+
+// A recursive wrapper may own the variant assigned to the variant holding
+// it, as in `v = v.get<node>().child`, so it is not assigned in place.
+template <typename T>
+struct is_recursive_wrapper : std::false_type {};
+
+template <typename T, typename Alloc>
+struct is_recursive_wrapper<recursive_wrapper<T, Alloc>> : std::true_type {};
+
+template <typename T>
+struct is_recursive_wrapper<shared_recursive_wrapper<T>> : std::true_type {};
+
+// Index and type of the first alternative wrapping a T.
+template <typename T, typename... Types>
+struct wrapper_type;
+
+template <typename T, typename First, typename... Types>
+struct wrapper_type<T, First, Types...>
+{
+    static constexpr type_index_t index = is_wrapper_of<First, T>::value
+        ? sizeof...(Types)
+        : wrapper_type<T, Types...>::index;
+    using type = typename std::conditional<is_wrapper_of<First, T>::value,
+                                           First, typename wrapper_type<T, Types...>::type>::type;
+};
+
+template <typename T>
+struct wrapper_type<T>
+{
+    static constexpr type_index_t index = invalid_value;
+    using type = void;
+};
+
 template <typename T, typename... Types>
 struct convertible_type;
 
@@ -170,10 +250,9 @@ template <typename T, typename... Types>
 struct value_traits
 {
     using value_type = typename std::remove_const<typename std::remove_reference<T>::type>::type;
-    using value_type_wrapper = recursive_wrapper<value_type>;
     static constexpr type_index_t direct_index = direct_type<value_type, Types...>::index;
     static constexpr bool is_direct = direct_index != invalid_value;
-    static constexpr type_index_t index_direct_or_wrapper = is_direct ? direct_index : direct_type<value_type_wrapper, Types...>::index;
+    static constexpr type_index_t index_direct_or_wrapper = is_direct ? direct_index : wrapper_type<value_type, Types...>::index;
     static constexpr bool is_direct_or_wrapper = index_direct_or_wrapper != invalid_value;
     static constexpr type_index_t index = is_direct_or_wrapper ? index_direct_or_wrapper : convertible_type<value_type, Types...>::index;
     static constexpr bool is_valid = index != invalid_value;
@@ -226,6 +305,60 @@ struct static_max<arg1, arg2, others...>
     static const type_index_t value = arg1 >= arg2 ? static_max<arg1, others...>::value : static_max<arg2, others...>::value;
 };
 
+template <std::size_t... Is>
+struct index_sequence
+{
+};
+
+template <typename Lhs, typename Rhs>
+struct concat_index_sequence;
+
+template <std::size_t... Ls, std::size_t... Rs>
+struct concat_index_sequence<index_sequence<Ls...>, index_sequence<Rs...>>
+{
+    using type = index_sequence<Ls..., (sizeof...(Ls) + Rs)...>;
+};
+
+// Builds the sequence from two halves, so that the instantiation depth
+// grows with log(N). The binary dispatch table of a variant with 32
+// alternatives needs 1024 indexes, more than the default depth limit.
+template <std::size_t N>
+struct make_index_sequence_impl
+    : concat_index_sequence<typename make_index_sequence_impl<N / 2>::type,
+                            typename make_index_sequence_impl<N - N / 2>::type>
+{
+};
+
+template <>
+struct make_index_sequence_impl<0>
+{
+    using type = index_sequence<>;
+};
+
+template <>
+struct make_index_sequence_impl<1>
+{
+    using type = index_sequence<0>;
+};
+
+template <std::size_t N>
+using make_index_sequence = typename make_index_sequence_impl<N>::type;
+
+// Assigns rhs to lhs if Assignable is true. Returns whether it did, so
+// that callers can fall back to destroying lhs and constructing it afresh.
+template <typename T, typename U>
+VARIANT_INLINE bool assign_if(std::true_type, T& lhs, U&& rhs)
+{
+    lhs = std::forward<U>(rhs);
+    return true;
+}
+
+template <typename T, typename U>
+VARIANT_INLINE bool assign_if(std::false_type, T&, U&&)
+{
+    return false;
+}
+
 template <typename... Types>
 struct variant_helper;
 
@@ -244,6 +377,59 @@ struct variant_helper<T, Types...>
         }
     }
 
+    // Whether the value may own other values, which it cannot if it is
+    // trivially destructible.
+    VARIANT_INLINE static bool may_own(const type_index_t type_index)
+    {
+        if (type_index == sizeof...(Types))
+        {
+            return !std::is_trivially_destructible<T>::value;
+        }
+        else
+        {
+            return variant_helper<Types...>::may_own(type_index);
+        }
+    }
+
+    // Copies the value at new_value, of type index new_type_index, into a
+    // temporary, then destroys the old value, which may own it, with Helper
+    // and moves the temporary into its place. type_index is left invalid if
+    // that move throws.
+    template <typename Helper, typename Index>
+    VARIANT_INLINE static void copy_replace(const type_index_t new_type_index, const void* new_value, Index& type_index, void* data)
+    {
+        if (new_type_index == sizeof...(Types))
+        {
+            T temp(*reinterpret_cast<const T*>(new_value));
+            Helper::destroy(type_index, data);
+            type_index = static_cast<Index>(invalid_value);
+            new (data) T(std::move(temp));
+            type_index = static_cast<Index>(new_type_index);
+        }
+        else
+        {
+            variant_helper<Types...>::template copy_replace<Helper>(new_type_index, new_value, type_index, data);
+        }
+    }
+
+    // Same as above, moving the value into the temporary.
+    template <typename Helper, typename Index>
+    VARIANT_INLINE static void move_replace(const type_index_t new_type_index, void* new_value, Index& type_index, void* data)
+    {
+        if (new_type_index == sizeof...(Types))
+        {
+            T temp(std::move(*reinterpret_cast<T*>(new_value)));
+            Helper::destroy(type_index, data);
+            type_index = static_cast<Index>(invalid_value);
+            new (data) T(std::move(temp));
+            type_index = static_cast<Index>(new_type_index);
+        }
+        else
+        {
+            variant_helper<Types...>::template move_replace<Helper>(new_type_index, new_value, type_index, data);
+        }
+    }
+
     VARIANT_INLINE static void move(const type_index_t old_type_index, void* old_value, void* new_value)
     {
         if (old_type_index == sizeof...(Types))
@@ -267,14 +453,50 @@ struct variant_helper<T, Types...>
             variant_helper<Types...>::copy(old_type_index, old_value, new_value);
         }
     }
+
+    // Assign a value of the same type in place, reusing whatever resources
+    // the old value holds. Return false if the type is not assignable or is
+    // a recursive wrapper.
+    VARIANT_INLINE static bool move_assign(const type_index_t type_index, void* old_value, void* new_value)
+    {
+        if (type_index == sizeof...(Types))
+        {
+            using in_place = std::integral_constant<bool, std::is_move_assignable<T>::value && !is_recursive_wrapper<T>::value>;
+            return assign_if(in_place(), *reinterpret_cast<T*>(new_value), std::move(*reinterpret_cast<T*>(old_value)));
+        }
+        else
+        {
+            return variant_helper<Types...>::move_assign(type_index, old_value, new_value);
+        }
+    }
+
+    VARIANT_INLINE static bool copy_assign(const type_index_t type_index, const void* old_value, void* new_value)
+    {
+        if (type_index == sizeof...(Types))
+        {
+            using in_place = std::integral_constant<bool, std::is_copy_assignable<T>::value && !is_recursive_wrapper<T>::value>;
+            return assign_if(in_place(), *reinterpret_cast<T*>(new_value), *reinterpret_cast<const T*>(old_value));
+        }
+        else
+        {
+            return variant_helper<Types...>::copy_assign(type_index, old_value, new_value);
+        }
+    }
 };
 
 template <>
 struct variant_helper<>
 {
     VARIANT_INLINE static void destroy(const type_index_t, void*) {}
+    VARIANT_INLINE static bool may_own(const type_index_t) { return false; }
+    template <typename Helper, typename Index>
+    VARIANT_INLINE static void copy_replace(const type_index_t, const void*, Index&, void*) {}
+    template <typename Helper, typename Index>
+    VARIANT_INLINE static void move_replace(const type_index_t, void*, Index&, void*) {}
     VARIANT_INLINE static void move(const type_index_t, void*, void*) {}
     VARIANT_INLINE static void copy(const type_index_t, const void*, void*) {}
+    VARIANT_INLINE static bool move_assign(const type_index_t, void*, void*) { return false; }
+    VARIANT_INLINE static bool copy_assign(const type_index_t, const void*, void*) { return false; }
 };
 
 template <typename T>
@@ -284,16 +506,33 @@ struct unwrapper
     static T& apply(T& obj) { return obj; }
 };
 
+template <typename T, typename Alloc>
+struct unwrapper<recursive_wrapper<T, Alloc>>
+{
+    static auto apply_const(recursive_wrapper<T, Alloc> const& obj)
+        -> typename recursive_wrapper<T, Alloc>::type const&
+    {
+        return obj.get();
+    }
+    static auto apply(recursive_wrapper<T, Alloc>& obj)
+        -> typename recursive_wrapper<T, Alloc>::type&
+    {
+        return obj.get();
+    }
+};
+
+// Visiting a non-const variant unshares the value, so that visitors can
+// modify it. Visit through a const variant to keep it shared.
 template <typename T>
-struct unwrapper<recursive_wrapper<T>>
+struct unwrapper<shared_recursive_wrapper<T>>
 {
-    static auto apply_const(recursive_wrapper<T> const& obj)
-        -> typename recursive_wrapper<T>::type const&
+    static auto apply_const(shared_recursive_wrapper<T> const& obj)
+        -> typename shared_recursive_wrapper<T>::type const&
     {
         return obj.get();
     }
-    static auto apply(recursive_wrapper<T>& obj)
-        -> typename recursive_wrapper<T>::type&
+    static auto apply(shared_recursive_wrapper<T>& obj)
+        -> typename shared_recursive_wrapper<T>::type&
     {
         return obj.get();
     }
@@ -359,6 +598,45 @@ struct dispatcher<F, V, R, T>
     }
 };
 
+// Dispatches in constant time through a table holding one function per
+// alternative, indexed by which().
+template <typename F, typename V, typename R, typename... Types>
+struct table_dispatcher
+{
+    template <typename T>
+    static R invoke_const(V const& v, F&& f)
+    {
+        return f(unwrapper<T>::apply_const(v.template get_unchecked<T>()));
+    }
+
+    template <typename T>
+    static R invoke(V& v, F&& f)
+    {
+        return f(unwrapper<T>::apply(v.template get_unchecked<T>()));
+    }
+
+    VARIANT_INLINE static R apply_const(V const& v, F&& f)
+    {
+        using function_type = R (*)(V const&, F&&);
+        static constexpr function_type table[] = {&invoke_const<Types>...};
+        assert(v.valid());
+        return table[static_cast<std::size_t>(v.which())](v, std::forward<F>(f));
+    }
+
+    VARIANT_INLINE static R apply(V& v, F&& f)
+    {
+        using function_type = R (*)(V&, F&&);
+        static constexpr function_type table[] = {&invoke<Types>...};
+        assert(v.valid());
+        return table[static_cast<std::size_t>(v.which())](v, std::forward<F>(f));
+    }
+};
+
+template <typename F, typename V, typename R, typename... Types>
+using dispatcher_for = typename std::conditional<(sizeof...(Types) > MAPBOX_VARIANT_DISPATCH_TABLE_THRESHOLD),
+                                                 table_dispatcher<F, V, R, Types...>,
+                                                 dispatcher<F, V, R, Types...>>::type;
+
 template <typename F, typename V, typename R, typename T, typename... Types>
 struct binary_dispatcher_rhs;
 
@@ -522,9 +800,227 @@ struct binary_dispatcher<F, V, R, T>
     }
 };
 
-// comparator functors
+// Dispatches in constant time through a flattened table holding one function
+// per pair of alternatives, indexed by which() of both operands. Operands
+// holding the same alternative are looked up in a separate, smaller table.
+template <typename F, typename V, typename R, typename... Types>
+struct binary_table_dispatcher
+{
+    static constexpr std::size_t size = sizeof...(Types);
+
+    template <std::size_t I>
+    using type_at = typename std::tuple_element<I, std::tuple<Types...>>::type;
+
+    template <typename T0, typename T1>
+    static R invoke_const(V const& v0, V const& v1, F&& f)
+    {
+        return f(unwrapper<T0>::apply_const(v0.template get_unchecked<T0>()),
+                 unwrapper<T1>::apply_const(v1.template get_unchecked<T1>()));
+    }
+
+    template <typename T0, typename T1>
+    static R invoke(V& v0, V& v1, F&& f)
+    {
+        return f(unwrapper<T0>::apply(v0.template get_unchecked<T0>()),
+                 unwrapper<T1>::apply(v1.template get_unchecked<T1>()));
+    }
+
+    template <std::size_t... Is>
+    VARIANT_INLINE static R apply_const(V const& v0, V const& v1, F&& f, index_sequence<Is...>)
+    {
+        using function_type = R (*)(V const&, V const&, F&&);
+        static constexpr function_type diagonal[] = {&invoke_const<Types, Types>...};
+        static constexpr function_type table[] = {&invoke_const<type_at<Is / size>, type_at<Is % size>>...};
+        assert(v0.valid() && v1.valid());
+        std::size_t const i0 = static_cast<std::size_t>(v0.which());
+        std::size_t const i1 = static_cast<std::size_t>(v1.which());
+        if (i0 == i1)
+        {
+            return diagonal[i0](v0, v1, std::forward<F>(f));
+        }
+        return table[i0 * size + i1](v0, v1, std::forward<F>(f));
+    }
+
+    template <std::size_t... Is>
+    VARIANT_INLINE static R apply(V& v0, V& v1, F&& f, index_sequence<Is...>)
+    {
+        using function_type = R (*)(V&, V&, F&&);
+        static constexpr function_type diagonal[] = {&invoke<Types, Types>...};
+        static constexpr function_type table[] = {&invoke<type_at<Is / size>, type_at<Is % size>>...};
+        assert(v0.valid() && v1.valid());
+        std::size_t const i0 = static_cast<std::size_t>(v0.which());
+        std::size_t const i1 = static_cast<std::size_t>(v1.which());
+        if (i0 == i1)
+        {
+            return diagonal[i0](v0, v1, std::forward<F>(f));
+        }
+        return table[i0 * size + i1](v0, v1, std::forward<F>(f));
+    }
+
+    VARIANT_INLINE static R apply_const(V const& v0, V const& v1, F&& f)
+    {
+        return apply_const(v0, v1, std::forward<F>(f), make_index_sequence<size * size>());
+    }
+
+    VARIANT_INLINE static R apply(V& v0, V& v1, F&& f)
+    {
+        return apply(v0, v1, std::forward<F>(f), make_index_sequence<size * size>());
+    }
+};
+
+template <typename F, typename V, typename R, typename... Types>
+using binary_dispatcher_for = typename std::conditional<(sizeof...(Types) > MAPBOX_VARIANT_BINARY_DISPATCH_TABLE_THRESHOLD),
+                                                        binary_table_dispatcher<F, V, R, Types...>,
+                                                        binary_dispatcher<F, V, R, Types...>>::type;
+
+template <typename T, typename Enable = void>
+struct is_variant : std::false_type
+{
+};
+
+template <typename T>
+struct is_variant<T, typename enable_if_type<typename T::adapted_variant_tag>::type> : std::true_type
+{
+};
+
+// Accessor for the alternative at position I of a (possibly const) variant.
+template <typename V, std::size_t I>
+struct alternative
+{
+    using type = typename std::tuple_element<I, typename V::types>::type;
+
+    static auto get(V& v) -> decltype(unwrapper<type>::apply(v.template get_unchecked<type>()))
+    {
+        return unwrapper<type>::apply(v.template get_unchecked<type>());
+    }
+};
+
+template <typename V, std::size_t I>
+struct alternative<V const, I>
+{
+    using type = typename std::tuple_element<I, typename V::types>::type;
+
+    static auto get(V const& v) -> decltype(unwrapper<type>::apply_const(v.template get_unchecked<type>()))
+    {
+        return unwrapper<type>::apply_const(v.template get_unchecked<type>());
+    }
+};
+
+template <std::size_t... Ns>
+struct static_product;
+
+template <>
+struct static_product<>
+{
+    static constexpr std::size_t value = 1;
+};
+
+template <std::size_t N, std::size_t... Ns>
+struct static_product<N, Ns...>
+{
+    static constexpr std::size_t value = N * static_product<Ns...>::value;
+};
+
+// Product of all Ns following the one at position K.
+template <std::size_t K, std::size_t... Ns>
+struct static_stride
+{
+    static constexpr std::size_t value = 1;
+};
+
+template <std::size_t K, std::size_t N, std::size_t... Ns>
+struct static_stride<K, N, Ns...>
+{
+    static constexpr std::size_t value = K == 0 ? static_product<Ns...>::value : static_stride<K - 1, Ns...>::value;
+};
+
+template <std::size_t... Ns>
+struct flat_index;
+
+template <>
+struct flat_index<>
+{
+    static std::size_t apply(std::size_t index)
+    {
+        return index;
+    }
+};
+
+template <std::size_t N, std::size_t... Ns>
+struct flat_index<N, Ns...>
+{
+    template <typename V, typename... Vs>
+    static std::size_t apply(std::size_t index, V const& v, Vs const&... vs)
+    {
+        assert(v.valid());
+        return flat_index<Ns...>::apply(index * N + static_cast<std::size_t>(v.which()), vs...);
+    }
+};
+
+template <typename F, typename Enable, typename... Vs>
+struct result_of_multi_visit_impl
+{
+    using type = decltype(std::declval<F&>()(alternative<Vs, 0>::get(std::declval<Vs&>())...));
+};
+
+template <typename F, typename... Vs>
+struct result_of_multi_visit_impl<F, typename enable_if_type<typename std::decay<F>::type::result_type>::type, Vs...>
+{
+    using type = typename std::decay<F>::type::result_type;
+};
+
+template <typename F, typename... Vs>
+using result_of_multi_visit = result_of_multi_visit_impl<F, void, Vs...>;
+
+// Dispatches visitation of any number of variants, possibly of different
+// types, in constant time through a single table holding one function for
+// every combination of alternatives. The table is indexed by the which() of
+// all operands, flattened in row-major order.
+template <typename F, typename R, typename Sizes, typename... Vs>
+struct multi_dispatcher_impl;
+
+template <typename F, typename R, std::size_t... Ns, typename... Vs>
+struct multi_dispatcher_impl<F, R, index_sequence<Ns...>, Vs...>
+{
+    static constexpr std::size_t size = static_product<Ns...>::value;
+
+    template <std::size_t K>
+    using stride = static_stride<K, Ns...>;
+
+    template <std::size_t I, std::size_t... Ks>
+    static R invoke(index_sequence<Ks...>, F&& f, Vs&... vs)
+    {
+        return f(alternative<Vs, (I / stride<Ks>::value) % Ns>::get(vs)...);
+    }
+
+    template <std::size_t I>
+    static R invoke(F&& f, Vs&... vs)
+    {
+        return invoke<I>(make_index_sequence<sizeof...(Vs)>(), std::forward<F>(f), vs...);
+    }
+
+    template <std::size_t... Is>
+    VARIANT_INLINE static R apply(index_sequence<Is...>, F&& f, Vs&... vs)
+    {
+        using function_type = R (*)(F&&, Vs&...);
+        static constexpr function_type table[] = {&invoke<Is>...};
+        return table[flat_index<Ns...>::apply(0, vs...)](std::forward<F>(f), vs...);
+    }
+
+    VARIANT_INLINE static R apply(F&& f, Vs&... vs)
+    {
+        return apply(make_index_sequence<size>(), std::forward<F>(f), vs...);
+    }
+};
+
+template <typename F, typename R, typename... Vs>
+using multi_dispatcher = multi_dispatcher_impl<F, R, index_sequence<std::tuple_size<typename std::remove_const<Vs>::type::types>::value...>, Vs...>;
+
+// comparator functors, with the result for a value compared to itself
 struct equal_comp
 {
+    static constexpr bool reflexive = true;
+
     template <typename T>
     bool operator()(T const& lhs, T const& rhs) const
     {
@@ -534,6 +1030,8 @@ struct equal_comp
 
 struct less_comp
 {
+    static constexpr bool reflexive = false;
+
     template <typename T>
     bool operator()(T const& lhs, T const& rhs) const
     {
@@ -541,6 +1039,17 @@ struct less_comp
     }
 };
 
+// Whether a variant with the given types holds T in a
+// shared_recursive_wrapper, so that two variants can share one T.
+template <typename T, typename Types>
+struct is_shared_alternative;
+
+template <typename T, typename... Types>
+struct is_shared_alternative<T, std::tuple<Types...>>
+    : std::is_same<typename wrapper_type<T, Types...>::type, shared_recursive_wrapper<T>>
+{
+};
+
 template <typename Variant, typename Comp>
 class comparer
 {
@@ -553,6 +1062,10 @@ public:
     bool operator()(T const& rhs_content) const
     {
         T const& lhs_content = lhs_.template get_unchecked<T>();
+        if (is_shared_alternative<T, typename Variant::types>::value && std::addressof(lhs_content) == std::addressof(rhs_content))
+        {
+            return Comp::reflexive;
+        }
         return Comp()(lhs_content, rhs_content);
     }
 
@@ -570,110 +1083,338 @@ struct hasher
     }
 };
 
+// Smallest unsigned type that can hold the indexes of N alternatives as well
+// as the invalid index.
+template <std::size_t N>
+struct index_type_for
+{
+    using type = typename std::conditional<
+        (N < 0xff), std::uint8_t,
+        typename std::conditional<(N < 0xffff), std::uint16_t, type_index_t>::type>::type;
+};
+
+// Holds the index of the stored type and the storage for the value. The
+// index is stored in the smallest type that fits and placed after the value,
+// so that it can go into the tail padding of the storage. The value is
+// destroyed by the destructor unless all alternatives are trivially
+// destructible, in which case the storage and the variant using it are
+// trivially destructible, too.
+template <bool TriviallyDestructible, typename... Types>
+class variant_storage
+{
+protected:
+    static const std::size_t data_size = static_max<sizeof(Types)...>::value;
+    static const std::size_t data_align = static_max<alignof(Types)...>::value;
+
+    using index_type = typename index_type_for<sizeof...(Types)>::type;
+    using helper_type = variant_helper<Types...>;
+
+    static constexpr index_type invalid_index = static_cast<index_type>(invalid_value);
+
+    explicit variant_storage(type_index_t index) noexcept
+        : type_index(static_cast<index_type>(index)) {}
+
+    ~variant_storage() noexcept // no-throw destructor
+    {
+        helper_type::destroy(type_index, &data);
+    }
+
+    alignas(data_align) unsigned char data[data_size];
+    index_type type_index;
+};
+
+template <typename... Types>
+class variant_storage<true, Types...>
+{
+protected:
+    static const std::size_t data_size = static_max<sizeof(Types)...>::value;
+    static const std::size_t data_align = static_max<alignof(Types)...>::value;
+
+    using index_type = typename index_type_for<sizeof...(Types)>::type;
+    using helper_type = variant_helper<Types...>;
+
+    static constexpr index_type invalid_index = static_cast<index_type>(invalid_value);
+
+    explicit variant_storage(type_index_t index) noexcept
+        : type_index(static_cast<index_type>(index)) {}
+
+    alignas(data_align) unsigned char data[data_size];
+    index_type type_index;
+};
+
+template <typename... Types>
+using variant_storage_for = variant_storage<conjunction<std::is_trivially_destructible<Types>...>::value, Types...>;
+
+// Copy and move operations of a variant. They dispatch on the stored type
+// unless all alternatives are trivially copyable, in which case they are
+// left to the compiler and copy the index and the storage bytes as they are.
+template <bool TriviallyCopyable, typename... Types>
+class variant_copy_base : public variant_storage_for<Types...>
+{
+    using base = variant_storage_for<Types...>;
+
+protected:
+    using base::type_index;
+    using base::data;
+    using base::invalid_index;
+    using typename base::helper_type;
+
+    explicit variant_copy_base(type_index_t index) noexcept
+        : base(index) {}
+
+    VARIANT_INLINE variant_copy_base(variant_copy_base const& old)
+        : base(invalid_value)
+    {
+        helper_type::copy(old.type_index, &old.data, &data);
+        type_index = old.type_index;
+    }
+
+    VARIANT_INLINE variant_copy_base(variant_copy_base&& old)
+        noexcept(conjunction<std::is_nothrow_move_constructible<Types>...>::value)
+        : base(invalid_value)
+    {
+        helper_type::move(old.type_index, &old.data, &data);
+        type_index = old.type_index;
+    }
+
+    VARIANT_INLINE variant_copy_base& operator=(variant_copy_base const& other)
+    {
+        copy_assign(other);
+        return *this;
+    }
+
+    VARIANT_INLINE variant_copy_base& operator=(variant_copy_base&& other)
+        noexcept(conjunction<std::is_nothrow_move_constructible<Types>...,
+                             std::is_nothrow_move_assignable<Types>...>::value)
+    {
+        move_assign(std::move(other));
+        return *this;
+    }
+
+    // If both sides hold the same type, use its assignment operator instead
+    // of destroying and constructing the value again. Otherwise rhs may be
+    // owned by the old value, as in `v = v.get<node>().child`, so unless
+    // the old value owns nothing, rhs is first copied or moved into a
+    // temporary. Recursive wrappers always take the second path.
+    VARIANT_INLINE void copy_assign(variant_copy_base const& rhs)
+    {
+        if (type_index == rhs.type_index && helper_type::copy_assign(type_index, &rhs.data, &data))
+        {
+            return;
+        }
+        if (rhs.type_index == invalid_index)
+        {
+            helper_type::destroy(type_index, &data);
+            type_index = invalid_index;
+            return;
+        }
+        if (helper_type::may_own(type_index))
+        {
+            helper_type::template copy_replace<helper_type>(rhs.type_index, &rhs.data, type_index, &data);
+            return;
+        }
+        helper_type::destroy(type_index, &data);
+        type_index = invalid_index;
+        helper_type::copy(rhs.type_index, &rhs.data, &data);
+        type_index = rhs.type_index;
+    }
+
+    VARIANT_INLINE void move_assign(variant_copy_base&& rhs)
+    {
+        if (type_index == rhs.type_index && helper_type::move_assign(type_index, &rhs.data, &data))
+        {
+            return;
+        }
+        if (rhs.type_index == invalid_index)
+        {
+            helper_type::destroy(type_index, &data);
+            type_index = invalid_index;
+            return;
+        }
+        if (helper_type::may_own(type_index))
+        {
+            helper_type::template move_replace<helper_type>(rhs.type_index, &rhs.data, type_index, &data);
+            return;
+        }
+        helper_type::destroy(type_index, &data);
+        type_index = invalid_index;
+        helper_type::move(rhs.type_index, &rhs.data, &data);
+        type_index = rhs.type_index;
+    }
+};
+
+template <typename... Types>
+class variant_copy_base<true, Types...> : public variant_storage_for<Types...>
+{
+    using base = variant_storage_for<Types...>;
+
+protected:
+    explicit variant_copy_base(type_index_t index) noexcept
+        : base(index) {}
+
+    VARIANT_INLINE void copy_assign(variant_copy_base const& rhs)
+    {
+        *this = rhs;
+    }
+
+    VARIANT_INLINE void move_assign(variant_copy_base&& rhs)
+    {
+        *this = rhs;
+    }
+};
+
+template <typename T>
+struct is_trivially_copyable_alternative
+    : conjunction<std::is_trivially_copy_constructible<T>,
+                  std::is_trivially_move_constructible<T>,
+                  std::is_trivially_copy_assignable<T>,
+                  std::is_trivially_move_assignable<T>,
+                  std::is_trivially_destructible<T>>
+{
+};
+
+// Owns its value, so it is never trivially copyable. Asking the type traits
+// would look at the converting constructors of recursive_wrapper, which
+// needs T to be complete.
+template <typename T, typename Alloc>
+struct is_trivially_copyable_alternative<recursive_wrapper<T, Alloc>> : std::false_type
+{
+};
+
+template <typename T>
+struct is_trivially_copyable_alternative<shared_recursive_wrapper<T>> : std::false_type
+{
+};
+
+template <typename... Types>
+using variant_copy_base_for = variant_copy_base<conjunction<is_trivially_copyable_alternative<Types>...>::value, Types...>;
+
 } // namespace detail
 
 struct no_init {};
 
+// Tags for the constructors that construct the value in place, selecting
+// the alternative by type or by zero based index.
+template <typename T>
+struct in_place_type_t {};
+
+template <std::size_t I>
+struct in_place_index_t {};
+
+#if __cplusplus >= 201402L
+template <typename T>
+constexpr in_place_type_t<T> in_place_type{};
+
+template <std::size_t I>
+constexpr in_place_index_t<I> in_place_index{};
+#endif
+
 template <typename... Types>
-class variant
+class variant : public detail::variant_copy_base_for<Types...>
 {
     static_assert(sizeof...(Types) > 0, "Template parameter type list of variant can not be empty.");
     static_assert(!detail::disjunction<std::is_reference<Types>...>::value, "Variant can not hold reference types. Maybe use std::reference_wrapper?");
     static_assert(!detail::disjunction<std::is_array<Types>...>::value, "Variant can not hold array types.");
     static_assert(sizeof...(Types) < std::numeric_limits<type_index_t>::max(), "Internal index type must be able to accommodate all alternatives.");
 private:
-    static const std::size_t data_size = detail::static_max<sizeof(Types)...>::value;
-    static const std::size_t data_align = detail::static_max<alignof(Types)...>::value;
+    using base = detail::variant_copy_base_for<Types...>;
 public:
     struct adapted_variant_tag;
     using types = std::tuple<Types...>;
 private:
     using first_type = typename std::tuple_element<0, types>::type;
-    using data_type = typename std::aligned_storage<data_size, data_align>::type;
-    using helper_type = detail::variant_helper<Types...>;
-
-    type_index_t type_index;
-    data_type data;
+    using typename base::helper_type;
+    using base::type_index;
+    using base::data;
+    using base::invalid_index;
+    using base::copy_assign;
+    using base::move_assign;
 
 public:
     VARIANT_INLINE variant() noexcept(std::is_nothrow_default_constructible<first_type>::value)
-        : type_index(sizeof...(Types)-1)
+        : base(detail::invalid_value)
     {
         static_assert(std::is_default_constructible<first_type>::value, "First type in variant must be default constructible to allow default construction of variant.");
         new (&data) first_type();
+        type_index = sizeof...(Types)-1;
     }
 
     VARIANT_INLINE variant(no_init) noexcept
-        : type_index(detail::invalid_value) {}
+        : base(detail::invalid_value) {}
 
     // http://isocpp.org/blog/2012/11/universal-references-in-c11-scott-meyers
     template <typename T, typename Traits = detail::value_traits<T, Types...>,
               typename Enable = typename std::enable_if<Traits::is_valid && !std::is_same<variant<Types...>, typename Traits::value_type>::value>::type >
     VARIANT_INLINE variant(T&& val) noexcept(std::is_nothrow_constructible<typename Traits::target_type, T&&>::value)
-        : type_index(Traits::index)
+        : base(detail::invalid_value)
     {
         new (&data) typename Traits::target_type(std::forward<T>(val));
+        type_index = Traits::index;
     }
 
-    VARIANT_INLINE variant(variant<Types...> const& old)
-        : type_index(old.type_index)
+    template <typename T, typename... Args, typename std::enable_if<
+                          (detail::direct_type<T, Types...>::index != detail::invalid_value) &&
+                          std::is_constructible<T, Args&&...>::value>::type* = nullptr>
+    VARIANT_INLINE explicit variant(in_place_type_t<T>, Args&&... args)
+        noexcept(std::is_nothrow_constructible<T, Args&&...>::value)
+        : base(detail::invalid_value)
     {
-        helper_type::copy(old.type_index, &old.data, &data);
-    }
-
-    VARIANT_INLINE variant(variant<Types...>&& old)
-        noexcept(detail::conjunction<std::is_nothrow_move_constructible<Types>...>::value)
-        : type_index(old.type_index)
-    {
-        helper_type::move(old.type_index, &old.data, &data);
-    }
-
-private:
-    VARIANT_INLINE void copy_assign(variant<Types...> const& rhs)
-    {
-        helper_type::destroy(type_index, &data);
-        type_index = detail::invalid_value;
-        helper_type::copy(rhs.type_index, &rhs.data, &data);
-        type_index = rhs.type_index;
+        new (&data) T(std::forward<Args>(args)...);
+        type_index = detail::direct_type<T, Types...>::index;
     }
 
-    VARIANT_INLINE void move_assign(variant<Types...>&& rhs)
+    template <std::size_t I, typename... Args, typename T = typename std::tuple_element<I, types>::type,
+              typename std::enable_if<std::is_constructible<T, Args&&...>::value>::type* = nullptr>
+    VARIANT_INLINE explicit variant(in_place_index_t<I>, Args&&... args)
+        noexcept(std::is_nothrow_constructible<T, Args&&...>::value)
+        : base(detail::invalid_value)
     {
-        helper_type::destroy(type_index, &data);
-        type_index = detail::invalid_value;
-        helper_type::move(rhs.type_index, &rhs.data, &data);
-        type_index = rhs.type_index;
+        static_assert(detail::type_count<T, Types...>::value == 1, "Alternatives selected by index must not be duplicated; the variant looks them up by type.");
+        new (&data) T(std::forward<Args>(args)...);
+        type_index = sizeof...(Types)-I - 1;
     }
 
-public:
-    VARIANT_INLINE variant<Types...>& operator=(variant<Types...>&& other)
+    // copy and move are trivial if all alternatives are trivially copyable
+    variant(variant<Types...> const&) = default;
+    variant(variant<Types...>&&) = default;
+#ifndef MAPBOX_VARIANT_INSTRUMENTATION
+    variant<Types...>& operator=(variant<Types...> const&) = default;
+    variant<Types...>& operator=(variant<Types...>&&) = default;
+#else
+    VARIANT_INLINE variant<Types...>& operator=(variant<Types...> const& rhs)
     {
-        move_assign(std::move(other));
+        MAPBOX_VARIANT_RECORD_ASSIGN(type_index, rhs.type_index);
+        copy_assign(rhs);
         return *this;
     }
 
-    VARIANT_INLINE variant<Types...>& operator=(variant<Types...> const& other)
+    VARIANT_INLINE variant<Types...>& operator=(variant<Types...>&& rhs)
+        noexcept(detail::conjunction<std::is_nothrow_move_constructible<Types>...,
+                                     std::is_nothrow_move_assignable<Types>...>::value)
     {
-        copy_assign(other);
+        MAPBOX_VARIANT_RECORD_ASSIGN(type_index, rhs.type_index);
+        move_assign(std::move(rhs));
         return *this;
     }
+#endif
 
     // conversions
-    // move-assign
-    template <typename T>
-    VARIANT_INLINE variant<Types...>& operator=(T&& rhs) noexcept
-    {
-        variant<Types...> temp(std::forward<T>(rhs));
-        move_assign(std::move(temp));
-        return *this;
-    }
-
-    // copy-assign
-    template <typename T>
-    VARIANT_INLINE variant<Types...>& operator=(T const& rhs)
-    {
-        variant<Types...> temp(rhs);
-        copy_assign(temp);
+    // Assigns in place if the variant already holds the target type and it
+    // is not a recursive wrapper, otherwise replaces the current value.
+    template <typename T, typename Traits = detail::value_traits<T, Types...>,
+              typename Enable = typename std::enable_if<Traits::is_valid && !std::is_same<variant<Types...>, typename Traits::value_type>::value>::type >
+    VARIANT_INLINE variant<Types...>& operator=(T&& rhs)
+    {
+        using target_type = typename Traits::target_type;
+        MAPBOX_VARIANT_RECORD_ASSIGN(type_index, Traits::index);
+        using in_place = std::integral_constant<bool, std::is_assignable<target_type&, T&&>::value &&
+                                                          !detail::is_recursive_wrapper<target_type>::value>;
+        if (type_index == Traits::index &&
+            detail::assign_if(in_place(), *reinterpret_cast<target_type*>(&data), std::forward<T>(rhs)))
+        {
+            return *this;
+        }
+        replace<target_type>(std::forward<T>(rhs));
         return *this;
     }
 
@@ -685,26 +1426,119 @@ public:
     }
 
     template <typename T,typename std::enable_if<
-                         (detail::direct_type<recursive_wrapper<T>, Types...>::index != detail::invalid_value)>::type* = nullptr>
+                         (detail::wrapper_type<T, Types...>::index != detail::invalid_value)>::type* = nullptr>
     VARIANT_INLINE bool is() const
     {
-        return type_index == detail::direct_type<recursive_wrapper<T>, Types...>::index;
+        return type_index == detail::wrapper_type<T, Types...>::index;
     }
 
     VARIANT_INLINE bool valid() const
     {
-        return type_index != detail::invalid_value;
+        return type_index != invalid_index;
     }
 
-    template <typename T, typename... Args>
-    VARIANT_INLINE void set(Args&&... args)
+private:
+    struct replace_copy_first {};
+    struct replace_in_place {};
+    struct replace_via_temporary {};
+
+    // Whether a value of type A held by the variant may contain an rvalue
+    // of type U assigned to it as a T. A trivially copyable A cannot contain
+    // anything that is not trivially copyable itself, and if A is T,
+    // can be assigned from U and is not a recursive wrapper, the value is
+    // assigned without reaching replace.
+    template <typename T, typename U, typename A>
+    struct may_contain
+        : std::integral_constant<bool, !(detail::is_trivially_copyable_alternative<A>::value ||
+                                         detail::conjunction<std::is_same<A, T>, std::is_assignable<T&, U&&>,
+                                                             std::integral_constant<bool, !detail::is_recursive_wrapper<T>::value>>::value)>
+    {
+    };
+
+    // rhs may refer into the old value, as in `v = v.get<node>().child` or
+    // `v = std::move(v.get<node>().child)`, so it is not read once the old
+    // value is destroyed. The T is constructed in place only if that cannot
+    // throw, so that the variant keeps its old value otherwise, and only if
+    // rhs cannot refer into the old value: a trivially copyable rhs is
+    // copied first, which costs no more than reading it, and an rvalue is
+    // used directly if no alternative may contain it. Otherwise rhs is used
+    // to construct a temporary T, which is then moved into place. If that
+    // move throws, the variant is left invalid, as with emplace.
+    template <typename T, typename U, typename Value = typename std::decay<U>::type>
+    using replace_strategy = typename std::conditional<
+        detail::is_trivially_copyable_alternative<Value>::value,
+        typename std::conditional<std::is_nothrow_constructible<T, Value&&>::value,
+                                  replace_copy_first,
+                                  replace_via_temporary>::type,
+        typename std::conditional<!std::is_lvalue_reference<U>::value &&
+                                      std::is_nothrow_constructible<T, U&&>::value &&
+                                      !detail::disjunction<may_contain<T, U, Types>...>::value,
+                                  replace_in_place,
+                                  replace_via_temporary>::type>::type;
+
+    template <typename T, typename U>
+    VARIANT_INLINE void replace(U&& rhs)
+    {
+        replace<T>(replace_strategy<T, U>(), std::forward<U>(rhs));
+    }
+
+    template <typename T, typename U>
+    VARIANT_INLINE void replace(replace_copy_first, U&& rhs)
+    {
+        typename std::decay<U>::type value(std::forward<U>(rhs));
+        replace<T>(replace_in_place(), std::move(value));
+    }
+
+    template <typename T, typename U>
+    VARIANT_INLINE void replace(replace_in_place, U&& rhs)
     {
         helper_type::destroy(type_index, &data);
-        type_index = detail::invalid_value;
-        new (&data) T(std::forward<Args>(args)...);
+        type_index = invalid_index;
+        new (&data) T(std::forward<U>(rhs));
         type_index = detail::direct_type<T, Types...>::index;
     }
 
+    template <typename T, typename U>
+    VARIANT_INLINE void replace(replace_via_temporary, U&& rhs)
+    {
+        T temp(std::forward<U>(rhs));
+        replace<T>(replace_in_place(), std::move(temp));
+    }
+
+public:
+    // Destroys the current value and constructs a T from args in its place.
+    // If the constructor throws, the variant is left invalid.
+    template <typename T, typename... Args, typename std::enable_if<
+                          (detail::direct_type<T, Types...>::index != detail::invalid_value)>::type* = nullptr>
+    VARIANT_INLINE T& emplace(Args&&... args)
+    {
+        MAPBOX_VARIANT_RECORD_ASSIGN(type_index, detail::direct_type<T, Types...>::index);
+        helper_type::destroy(type_index, &data);
+        type_index = invalid_index;
+        T* value = new (&data) T(std::forward<Args>(args)...);
+        type_index = detail::direct_type<T, Types...>::index;
+        return *value;
+    }
+
+    // Same as above, with the alternative given by its zero based index.
+    template <std::size_t I, typename... Args, typename T = typename std::tuple_element<I, types>::type>
+    VARIANT_INLINE T& emplace(Args&&... args)
+    {
+        static_assert(detail::type_count<T, Types...>::value == 1, "Alternatives selected by index must not be duplicated; the variant looks them up by type.");
+        MAPBOX_VARIANT_RECORD_ASSIGN(type_index, sizeof...(Types)-I - 1);
+        helper_type::destroy(type_index, &data);
+        type_index = invalid_index;
+        T* value = new (&data) T(std::forward<Args>(args)...);
+        type_index = sizeof...(Types)-I - 1;
+        return *value;
+    }
+
+    template <typename T, typename... Args>
+    VARIANT_INLINE void set(Args&&... args)
+    {
+        emplace<T>(std::forward<Args>(args)...);
+    }
+
     // get_unchecked<T>()
     template <typename T, typename std::enable_if<
                           (detail::direct_type<T, Types...>::index != detail::invalid_value)>::type* = nullptr>
@@ -721,6 +1555,7 @@ public:
     {
         if (type_index == detail::direct_type<T, Types...>::index)
         {
+            MAPBOX_VARIANT_RECORD_GET(detail::direct_type<T, Types...>::index);
             return *reinterpret_cast<T*>(&data);
         }
         else
@@ -744,6 +1579,7 @@ public:
     {
         if (type_index == detail::direct_type<T, Types...>::index)
         {
+            MAPBOX_VARIANT_RECORD_GET(detail::direct_type<T, Types...>::index);
             return *reinterpret_cast<T const*>(&data);
         }
         else
@@ -753,23 +1589,24 @@ public:
     }
 #endif
 
-    // get_unchecked<T>() - T stored as recursive_wrapper<T>
+    // get_unchecked<T>() - T stored as recursive_wrapper<T> or another wrapper of T
     template <typename T, typename std::enable_if<
-                          (detail::direct_type<recursive_wrapper<T>, Types...>::index != detail::invalid_value)>::type* = nullptr>
+                          (detail::wrapper_type<T, Types...>::index != detail::invalid_value)>::type* = nullptr>
     VARIANT_INLINE T& get_unchecked()
     {
-        return (*reinterpret_cast<recursive_wrapper<T>*>(&data)).get();
+        return (*reinterpret_cast<typename detail::wrapper_type<T, Types...>::type*>(&data)).get();
     }
 
 #ifdef HAS_EXCEPTIONS
-    // get<T>() - T stored as recursive_wrapper<T>
+    // get<T>() - T stored as recursive_wrapper<T> or another wrapper of T
     template <typename T, typename std::enable_if<
-                          (detail::direct_type<recursive_wrapper<T>, Types...>::index != detail::invalid_value)>::type* = nullptr>
+                          (detail::wrapper_type<T, Types...>::index != detail::invalid_value)>::type* = nullptr>
     VARIANT_INLINE T& get()
     {
-        if (type_index == detail::direct_type<recursive_wrapper<T>, Types...>::index)
+        if (type_index == detail::wrapper_type<T, Types...>::index)
         {
-            return (*reinterpret_cast<recursive_wrapper<T>*>(&data)).get();
+            MAPBOX_VARIANT_RECORD_GET(detail::wrapper_type<T, Types...>::index);
+            return (*reinterpret_cast<typename detail::wrapper_type<T, Types...>::type*>(&data)).get();
         }
         else
         {
@@ -779,20 +1616,21 @@ public:
 #endif
 
     template <typename T, typename std::enable_if<
-                          (detail::direct_type<recursive_wrapper<T>, Types...>::index != detail::invalid_value)>::type* = nullptr>
+                          (detail::wrapper_type<T, Types...>::index != detail::invalid_value)>::type* = nullptr>
     VARIANT_INLINE T const& get_unchecked() const
     {
-        return (*reinterpret_cast<recursive_wrapper<T> const*>(&data)).get();
+        return (*reinterpret_cast<typename detail::wrapper_type<T, Types...>::type const*>(&data)).get();
     }
 
 #ifdef HAS_EXCEPTIONS
     template <typename T, typename std::enable_if<
-                          (detail::direct_type<recursive_wrapper<T>, Types...>::index != detail::invalid_value)>::type* = nullptr>
+                          (detail::wrapper_type<T, Types...>::index != detail::invalid_value)>::type* = nullptr>
     VARIANT_INLINE T const& get() const
     {
-        if (type_index == detail::direct_type<recursive_wrapper<T>, Types...>::index)
+        if (type_index == detail::wrapper_type<T, Types...>::index)
         {
-            return (*reinterpret_cast<recursive_wrapper<T> const*>(&data)).get();
+            MAPBOX_VARIANT_RECORD_GET(detail::wrapper_type<T, Types...>::index);
+            return (*reinterpret_cast<typename detail::wrapper_type<T, Types...>::type const*>(&data)).get();
         }
         else
         {
@@ -817,6 +1655,7 @@ public:
     {
         if (type_index == detail::direct_type<std::reference_wrapper<T>, Types...>::index)
         {
+            MAPBOX_VARIANT_RECORD_GET(detail::direct_type<std::reference_wrapper<T>, Types...>::index);
             return (*reinterpret_cast<std::reference_wrapper<T>*>(&data)).get();
         }
         else
@@ -840,6 +1679,7 @@ public:
     {
         if (type_index == detail::direct_type<std::reference_wrapper<T const>, Types...>::index)
         {
+            MAPBOX_VARIANT_RECORD_GET(detail::direct_type<std::reference_wrapper<T const>, Types...>::index);
             return (*reinterpret_cast<std::reference_wrapper<T const> const*>(&data)).get();
         }
         else
@@ -853,7 +1693,7 @@ public:
     // Use which() instead.
     MAPBOX_VARIANT_DEPRECATED VARIANT_INLINE type_index_t get_type_index() const
     {
-        return type_index;
+        return valid() ? type_index : detail::invalid_value;
     }
 
     VARIANT_INLINE int which() const noexcept
@@ -872,32 +1712,38 @@ public:
     // unary
     template <typename F, typename V, typename R = typename detail::result_of_unary_visit<F, first_type>::type>
     auto VARIANT_INLINE static visit(V const& v, F&& f)
-        -> decltype(detail::dispatcher<F, V, R, Types...>::apply_const(v, std::forward<F>(f)))
+        -> decltype(detail::dispatcher_for<F, V, R, Types...>::apply_const(v, std::forward<F>(f)))
     {
-        return detail::dispatcher<F, V, R, Types...>::apply_const(v, std::forward<F>(f));
+        MAPBOX_VARIANT_RECORD_VISIT(static_cast<variant const&>(v).type_index);
+        return detail::dispatcher_for<F, V, R, Types...>::apply_const(v, std::forward<F>(f));
     }
     // non-const
     template <typename F, typename V, typename R = typename detail::result_of_unary_visit<F, first_type>::type>
     auto VARIANT_INLINE static visit(V& v, F&& f)
-        -> decltype(detail::dispatcher<F, V, R, Types...>::apply(v, std::forward<F>(f)))
+        -> decltype(detail::dispatcher_for<F, V, R, Types...>::apply(v, std::forward<F>(f)))
     {
-        return detail::dispatcher<F, V, R, Types...>::apply(v, std::forward<F>(f));
+        MAPBOX_VARIANT_RECORD_VISIT(static_cast<variant const&>(v).type_index);
+        return detail::dispatcher_for<F, V, R, Types...>::apply(v, std::forward<F>(f));
     }
 
     // binary
     // const
     template <typename F, typename V, typename R = typename detail::result_of_binary_visit<F, first_type>::type>
     auto VARIANT_INLINE static binary_visit(V const& v0, V const& v1, F&& f)
-        -> decltype(detail::binary_dispatcher<F, V, R, Types...>::apply_const(v0, v1, std::forward<F>(f)))
+        -> decltype(detail::binary_dispatcher_for<F, V, R, Types...>::apply_const(v0, v1, std::forward<F>(f)))
     {
-        return detail::binary_dispatcher<F, V, R, Types...>::apply_const(v0, v1, std::forward<F>(f));
+        MAPBOX_VARIANT_RECORD_VISIT(static_cast<variant const&>(v0).type_index);
+        MAPBOX_VARIANT_RECORD_VISIT(static_cast<variant const&>(v1).type_index);
+        return detail::binary_dispatcher_for<F, V, R, Types...>::apply_const(v0, v1, std::forward<F>(f));
     }
     // non-const
     template <typename F, typename V, typename R = typename detail::result_of_binary_visit<F, first_type>::type>
     auto VARIANT_INLINE static binary_visit(V& v0, V& v1, F&& f)
-        -> decltype(detail::binary_dispatcher<F, V, R, Types...>::apply(v0, v1, std::forward<F>(f)))
+        -> decltype(detail::binary_dispatcher_for<F, V, R, Types...>::apply(v0, v1, std::forward<F>(f)))
     {
-        return detail::binary_dispatcher<F, V, R, Types...>::apply(v0, v1, std::forward<F>(f));
+        MAPBOX_VARIANT_RECORD_VISIT(static_cast<variant const&>(v0).type_index);
+        MAPBOX_VARIANT_RECORD_VISIT(static_cast<variant const&>(v1).type_index);
+        return detail::binary_dispatcher_for<F, V, R, Types...>::apply(v0, v1, std::forward<F>(f));
     }
 
     // match
@@ -916,11 +1762,6 @@ public:
         return variant::visit(*this, ::mapbox::util::make_visitor(std::forward<Fs>(fs)...));
     }
 
-    ~variant() noexcept // no-throw destructor
-    {
-        helper_type::destroy(type_index, &data);
-    }
-
     // comparison operators
     // equality
     VARIANT_INLINE bool operator==(variant const& rhs) const
@@ -994,6 +1835,26 @@ auto VARIANT_INLINE apply_visitor(F&& f, V& v0, V& v1) -> decltype(V::binary_vis
     return V::binary_visit(v0, v1, std::forward<F>(f));
 }
 
+// n-ary visitor interface, operands may be variants of different types
+template <typename F, typename V0, typename V1, typename... Vs,
+          typename Enable = typename std::enable_if<
+              (sizeof...(Vs) > 0 || !std::is_same<typename std::decay<V0>::type, typename std::decay<V1>::type>::value) &&
+              detail::conjunction<detail::is_variant<typename std::decay<V0>::type>,
+                                  detail::is_variant<typename std::decay<V1>::type>,
+                                  detail::is_variant<typename std::decay<Vs>::type>...>::value>::type>
+auto VARIANT_INLINE apply_visitor(F&& f, V0&& v0, V1&& v1, Vs&&... vs)
+    -> typename detail::result_of_multi_visit<F, typename std::remove_reference<V0>::type,
+                                              typename std::remove_reference<V1>::type,
+                                              typename std::remove_reference<Vs>::type...>::type
+{
+    using R = typename detail::result_of_multi_visit<F, typename std::remove_reference<V0>::type,
+                                                     typename std::remove_reference<V1>::type,
+                                                     typename std::remove_reference<Vs>::type...>::type;
+    return detail::multi_dispatcher<F, R, typename std::remove_reference<V0>::type,
+                                    typename std::remove_reference<V1>::type,
+                                    typename std::remove_reference<Vs>::type...>::apply(std::forward<F>(f), v0, v1, vs...);
+}
+
 // getter interface
 
 #ifdef HAS_EXCEPTIONS
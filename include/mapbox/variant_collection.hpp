@@ -0,0 +1,257 @@
+#ifndef MAPBOX_UTIL_VARIANT_COLLECTION_HPP
+#define MAPBOX_UTIL_VARIANT_COLLECTION_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <mapbox/detail/columns.hpp>
+#include <mapbox/variant.hpp>
+
+namespace mapbox {
+namespace util {
+
+/**
+ * An unordered collection of variant<Types...> values which keeps the
+ * values of each alternative together in a segment of their own, a
+ * std::vector of that alternative. Visiting all values with for_each runs
+ * one loop per segment, in which the type is known at compile time: there
+ * is no dispatch on the type of each value, and the visitor can be inlined
+ * and the loop vectorized.
+ *
+ * The order in which values were inserted is not kept. for_each visits the
+ * segments in the order of Types..., and the values of a segment in the
+ * order they were inserted.
+ *
+ * The segment of bools holds bool_cells, one byte each, rather than being a
+ * bit packed std::vector<bool>.
+ */
+template <typename... Types>
+class variant_collection
+{
+    static_assert(sizeof...(Types) > 0, "Template parameter type list of variant_collection can not be empty.");
+
+public:
+    using value_type = variant<Types...>;
+    using size_type = std::size_t;
+
+    // A bool taking a byte, stored for bool alternatives so that their
+    // segment is not a bit packed std::vector<bool>. Its value member holds
+    // the bool.
+    using bool_cell = detail::bool_cell;
+
+    // Type stored for the I-th alternative: the alternative itself, or
+    // bool_cell for bool.
+    template <std::size_t I>
+    using cell_type = typename detail::vector_column<typename std::tuple_element<I, std::tuple<Types...>>::type>::type;
+
+    template <std::size_t I>
+    using segment_type = std::vector<cell_type<I>>;
+
+private:
+    template <typename T>
+    using alternative = detail::alternative_of<T, Types...>;
+
+    template <typename T>
+    using enable_if_alternative = typename std::enable_if<alternative<T>::is_valid>::type;
+
+    template <std::size_t I>
+    using type_at = typename std::tuple_element<I, std::tuple<Types...>>::type;
+
+    using indexes = detail::make_index_sequence<sizeof...(Types)>;
+
+public:
+    variant_collection() = default;
+
+    size_type size() const noexcept
+    {
+        return total_size(indexes());
+    }
+
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    // Number of values holding a T.
+    template <typename T, typename = enable_if_alternative<T>>
+    size_type size() const noexcept
+    {
+        return segment<T>().size();
+    }
+
+    template <typename T, typename = enable_if_alternative<T>>
+    void reserve(size_type n)
+    {
+        segment<T>().reserve(n);
+    }
+
+    void clear() noexcept
+    {
+        clear(indexes());
+    }
+
+    // Adds a T constructed from args, where T is an alternative or the type
+    // wrapped by one, and returns the value it holds, unwrapped.
+    template <typename T, typename... Args, typename = enable_if_alternative<T>>
+    typename alternative<T>::value_type& emplace(Args&&... args)
+    {
+        using stored_type = typename alternative<T>::type;
+        auto& s = segment<T>();
+        s.emplace_back(std::forward<Args>(args)...);
+        return detail::unwrapper<stored_type>::apply(detail::vector_column<stored_type>::get(s.back()));
+    }
+
+    template <typename T, typename Value = typename std::remove_cv<typename std::remove_reference<T>::type>::type,
+              typename = enable_if_alternative<Value>>
+    void insert(T&& value)
+    {
+        emplace<Value>(std::forward<T>(value));
+    }
+
+    void insert(value_type const& v)
+    {
+        insert_variant(v, indexes());
+    }
+
+    void insert(value_type&& v)
+    {
+        insert_variant(std::move(v), indexes());
+    }
+
+    // The values holding a T. For an alternative wrapping T, such as
+    // recursive_wrapper<T>, this is a vector of the wrappers.
+    template <typename T, typename = enable_if_alternative<T>>
+    segment_type<alternative<T>::index>& segment() noexcept
+    {
+        return std::get<alternative<T>::index>(segments_);
+    }
+
+    template <typename T, typename = enable_if_alternative<T>>
+    segment_type<alternative<T>::index> const& segment() const noexcept
+    {
+        return std::get<alternative<T>::index>(segments_);
+    }
+
+    template <std::size_t I>
+    segment_type<I>& segment() noexcept { return std::get<I>(segments_); }
+
+    template <std::size_t I>
+    segment_type<I> const& segment() const noexcept { return std::get<I>(segments_); }
+
+    // Calls f with every value, unwrapped like apply_visitor does. f must
+    // accept all alternatives, but need not return the same type for all.
+    template <typename F>
+    void for_each(F&& f)
+    {
+        for_each_segment(f, indexes());
+    }
+
+    template <typename F>
+    void for_each(F&& f) const
+    {
+        for_each_segment(f, indexes());
+    }
+
+    // Calls f with every value holding a T.
+    template <typename T, typename F, typename = enable_if_alternative<T>>
+    void for_each(F&& f)
+    {
+        visit_segment<alternative<T>::index>(f);
+    }
+
+    template <typename T, typename F, typename = enable_if_alternative<T>>
+    void for_each(F&& f) const
+    {
+        visit_segment<alternative<T>::index>(f);
+    }
+
+private:
+    template <std::size_t I, typename F>
+    void visit_segment(F& f)
+    {
+        for (auto& value : std::get<I>(segments_))
+        {
+            f(detail::unwrapper<type_at<I>>::apply(detail::vector_column<type_at<I>>::get(value)));
+        }
+    }
+
+    template <std::size_t I, typename F>
+    void visit_segment(F& f) const
+    {
+        for (auto const& value : std::get<I>(segments_))
+        {
+            f(detail::unwrapper<type_at<I>>::apply_const(detail::vector_column<type_at<I>>::get(value)));
+        }
+    }
+
+    template <typename F, std::size_t... Is>
+    void for_each_segment(F& f, detail::index_sequence<Is...>)
+    {
+        int expand[] = {0, (visit_segment<Is>(f), 0)...};
+        (void)expand;
+    }
+
+    template <typename F, std::size_t... Is>
+    void for_each_segment(F& f, detail::index_sequence<Is...>) const
+    {
+        int expand[] = {0, (visit_segment<Is>(f), 0)...};
+        (void)expand;
+    }
+
+    template <std::size_t... Is>
+    size_type total_size(detail::index_sequence<Is...>) const noexcept
+    {
+        size_type total = 0;
+        int expand[] = {0, (total += std::get<Is>(segments_).size(), 0)...};
+        (void)expand;
+        return total;
+    }
+
+    template <std::size_t... Is>
+    void clear(detail::index_sequence<Is...>) noexcept
+    {
+        int expand[] = {0, (std::get<Is>(segments_).clear(), 0)...};
+        (void)expand;
+    }
+
+    template <std::size_t I>
+    static void insert_copy(variant_collection& self, value_type const& v)
+    {
+        std::get<I>(self.segments_).push_back(v.template get_unchecked<type_at<I>>());
+    }
+
+    template <std::size_t I>
+    static void insert_move(variant_collection& self, value_type& v)
+    {
+        std::get<I>(self.segments_).push_back(std::move(v.template get_unchecked<type_at<I>>()));
+    }
+
+    template <std::size_t... Is>
+    void insert_variant(value_type const& v, detail::index_sequence<Is...>)
+    {
+        using function_type = void (*)(variant_collection&, value_type const&);
+        static constexpr function_type table[] = {&insert_copy<Is>...};
+        assert(v.valid());
+        table[static_cast<std::size_t>(v.which())](*this, v);
+    }
+
+    template <std::size_t... Is>
+    void insert_variant(value_type&& v, detail::index_sequence<Is...>)
+    {
+        using function_type = void (*)(variant_collection&, value_type&);
+        static constexpr function_type table[] = {&insert_move<Is>...};
+        assert(v.valid());
+        table[static_cast<std::size_t>(v.which())](*this, v);
+    }
+
+    std::tuple<std::vector<typename detail::vector_column<Types>::type>...> segments_;
+};
+
+} // namespace util
+} // namespace mapbox
+
+#endif // MAPBOX_UTIL_VARIANT_COLLECTION_HPP
@@ -0,0 +1,326 @@
+#ifndef MAPBOX_UTIL_VARIANT_INSTRUMENTATION_HPP
+#define MAPBOX_UTIL_VARIANT_INSTRUMENTATION_HPP
+
+// Counts, for each variant type, how often each alternative is visited,
+// read with a checked get() and assigned, and which alternative replaced
+// which on assignment. Enabled by defining MAPBOX_VARIANT_INSTRUMENTATION
+// before including variant.hpp, in every translation unit of the program;
+// without it variant.hpp does not include this header and the hooks
+// compile to nothing.
+//
+// Visits count every unary and binary dispatch on the stored type, including
+// those done by comparison operators; apply_visitor() on more than two
+// variants is not counted. Gets count only checked get() calls that find
+// the alternative they ask for, not those throwing bad_variant_access.
+// Assignments count assignment from a variant or a
+// value, and emplace(). Counters are updated atomically and can be read
+// while other threads use the variants.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#if defined(__GNUC__) && defined(__has_include)
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#define MAPBOX_VARIANT_HAS_DEMANGLE
+#endif
+#endif
+
+namespace mapbox {
+namespace util {
+
+template <typename... Types>
+class variant;
+
+// Counts of one variant type. Alternatives are in declaration order.
+struct variant_counts
+{
+    std::string type;
+    std::vector<std::string> alternatives;
+    std::vector<std::uint64_t> visits;
+    std::vector<std::uint64_t> gets;
+    std::vector<std::uint64_t> assignments;              // by new alternative
+    std::vector<std::vector<std::uint64_t>> transitions; // [old][new], from valid variants
+
+    std::uint64_t total() const
+    {
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i < alternatives.size(); ++i)
+        {
+            sum += visits[i] + gets[i] + assignments[i];
+        }
+        return sum;
+    }
+
+    // Assignments that kept the alternative, which assign in place.
+    std::uint64_t same_type_assignments() const
+    {
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i < alternatives.size(); ++i)
+        {
+            sum += transitions[i][i];
+        }
+        return sum;
+    }
+};
+
+namespace detail {
+
+inline std::string type_name(std::type_info const& type)
+{
+#ifdef MAPBOX_VARIANT_HAS_DEMANGLE
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    if (status == 0 && demangled)
+    {
+        std::string name(demangled);
+        std::free(demangled);
+        return name;
+    }
+#endif
+    return type.name();
+}
+
+class variant_probe_base
+{
+public:
+    virtual variant_counts counts() const = 0;
+    virtual void reset() = 0;
+
+protected:
+    ~variant_probe_base() = default;
+};
+
+// The probes of all variant types used so far.
+class variant_probe_registry
+{
+public:
+    static variant_probe_registry& instance()
+    {
+        static variant_probe_registry registry;
+        return registry;
+    }
+
+    void add(variant_probe_base* probe)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        probes_.push_back(probe);
+    }
+
+    void remove(variant_probe_base* probe)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        probes_.erase(std::remove(probes_.begin(), probes_.end(), probe), probes_.end());
+    }
+
+    std::vector<variant_counts> counts() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<variant_counts> result;
+        for (variant_probe_base const* probe : probes_)
+        {
+            result.push_back(probe->counts());
+        }
+        return result;
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (variant_probe_base* probe : probes_)
+        {
+            probe->reset();
+        }
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<variant_probe_base*> probes_;
+};
+
+// Counters of variant<Types...>. The hooks pass the stored index, which
+// counts alternatives from the back.
+template <typename... Types>
+class variant_probe final : public variant_probe_base
+{
+    static constexpr std::size_t size = sizeof...(Types);
+
+public:
+    static variant_probe& instance()
+    {
+        static variant_probe probe;
+        return probe;
+    }
+
+    void visited(std::size_t index)
+    {
+        if (index < size)
+        {
+            visits_[size - index - 1].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void accessed(std::size_t index)
+    {
+        gets_[size - index - 1].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Either index may be invalid_index when an invalid variant is assigned
+    // to or from. Such assignments are not counted.
+    void assigned(std::size_t old_index, std::size_t new_index)
+    {
+        if (new_index >= size)
+        {
+            return;
+        }
+        std::size_t const to = size - new_index - 1;
+        assignments_[to].fetch_add(1, std::memory_order_relaxed);
+        if (old_index < size)
+        {
+            transitions_[(size - old_index - 1) * size + to].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    variant_counts counts() const override
+    {
+        variant_counts c;
+        c.type = type_name(typeid(variant<Types...>));
+        c.alternatives = {type_name(typeid(Types))...};
+        c.transitions.resize(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            c.visits.push_back(visits_[i].load(std::memory_order_relaxed));
+            c.gets.push_back(gets_[i].load(std::memory_order_relaxed));
+            c.assignments.push_back(assignments_[i].load(std::memory_order_relaxed));
+            for (std::size_t j = 0; j < size; ++j)
+            {
+                c.transitions[i].push_back(transitions_[i * size + j].load(std::memory_order_relaxed));
+            }
+        }
+        return c;
+    }
+
+    void reset() override
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            visits_[i].store(0, std::memory_order_relaxed);
+            gets_[i].store(0, std::memory_order_relaxed);
+            assignments_[i].store(0, std::memory_order_relaxed);
+        }
+        for (std::size_t i = 0; i < size * size; ++i)
+        {
+            transitions_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    variant_probe()
+    {
+        reset();
+        variant_probe_registry::instance().add(this);
+    }
+
+    ~variant_probe()
+    {
+        variant_probe_registry::instance().remove(this);
+    }
+
+    std::atomic<std::uint64_t> visits_[size];
+    std::atomic<std::uint64_t> gets_[size];
+    std::atomic<std::uint64_t> assignments_[size];
+    std::atomic<std::uint64_t> transitions_[size * size];
+};
+
+template <typename Variant>
+struct variant_probe_of;
+
+template <typename... Types>
+struct variant_probe_of<variant<Types...>>
+{
+    using type = variant_probe<Types...>;
+};
+
+} // namespace detail
+
+// Returns the counts of every variant type used so far, the most used first.
+inline std::vector<variant_counts> instrumentation_counts()
+{
+    std::vector<variant_counts> result = detail::variant_probe_registry::instance().counts();
+    std::stable_sort(result.begin(), result.end(), [](variant_counts const& lhs, variant_counts const& rhs) {
+        return lhs.total() > rhs.total();
+    });
+    return result;
+}
+
+// Returns the counts of one variant type.
+template <typename Variant>
+variant_counts instrumentation_counts()
+{
+    return detail::variant_probe_of<Variant>::type::instance().counts();
+}
+
+inline void reset_instrumentation()
+{
+    detail::variant_probe_registry::instance().reset();
+}
+
+// Writes the counts of every variant type that was used as a table, with
+// the transitions of each as a matrix of old (rows) to new (columns)
+// alternatives.
+inline void dump_instrumentation(std::ostream& out)
+{
+    for (variant_counts const& c : instrumentation_counts())
+    {
+        if (c.total() == 0)
+        {
+            continue;
+        }
+        std::vector<std::string> labels;
+        std::size_t width = 11;
+        for (std::size_t i = 0; i < c.alternatives.size(); ++i)
+        {
+            labels.push_back(std::to_string(i) + ": " + c.alternatives[i]);
+            width = std::max(width, labels.back().size());
+        }
+        int const name_width = static_cast<int>(width + 2);
+        out << c.type << "\n"
+            << "  " << std::left << std::setw(name_width) << "alternative" << std::right
+            << std::setw(12) << "visits" << std::setw(12) << "gets" << std::setw(12) << "assignments" << "\n";
+        for (std::size_t i = 0; i < c.alternatives.size(); ++i)
+        {
+            out << "  " << std::left << std::setw(name_width) << labels[i] << std::right
+                << std::setw(12) << c.visits[i] << std::setw(12) << c.gets[i] << std::setw(12) << c.assignments[i] << "\n";
+        }
+        out << "  " << std::left << std::setw(name_width) << "old \\ new" << std::right;
+        for (std::size_t j = 0; j < c.alternatives.size(); ++j)
+        {
+            out << std::setw(12) << j;
+        }
+        out << "\n";
+        for (std::size_t i = 0; i < c.alternatives.size(); ++i)
+        {
+            out << "  " << std::left << std::setw(name_width) << i << std::right;
+            for (std::size_t j = 0; j < c.alternatives.size(); ++j)
+            {
+                out << std::setw(12) << c.transitions[i][j];
+            }
+            out << "\n";
+        }
+        out << "\n";
+    }
+}
+
+} // namespace util
+} // namespace mapbox
+
+#endif // MAPBOX_UTIL_VARIANT_INSTRUMENTATION_HPP
@@ -0,0 +1,714 @@
+#ifndef MAPBOX_UTIL_VARIANT_VECTOR_HPP
+#define MAPBOX_UTIL_VARIANT_VECTOR_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <mapbox/detail/columns.hpp>
+#include <mapbox/variant.hpp>
+
+namespace mapbox {
+namespace util {
+
+/**
+ * The values of one column of a variant_vector, which can be read and
+ * written in place. Unlike the std::vector holding them, it cannot change
+ * the number of values, which would break the offsets indexing into it.
+ */
+template <typename T>
+class column_span
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = T*;
+
+    column_span(T* data, size_type size) noexcept
+        : data_(data), size_(size) {}
+
+    T* data() const noexcept { return data_; }
+    size_type size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    iterator begin() const noexcept { return data_; }
+    iterator end() const noexcept { return data_ + size_; }
+
+    T& operator[](size_type i) const noexcept { return data_[i]; }
+
+private:
+    T* data_;
+    size_type size_;
+};
+
+/**
+ * A sequence of variant<Types...> values stored as a struct of arrays: a
+ * column of one byte tags giving the alternative of each element, a column
+ * of 32 bit offsets, and one std::vector per alternative holding the values
+ * of that alternative in order. An int element takes 9 bytes instead of
+ * the size of the whole variant, and scanning the tags or a single
+ * alternative touches only the memory it needs.
+ *
+ * Elements are accessed through lightweight proxy references supporting
+ * which(), is<T>(), get<T>() and apply_visitor(). An element can be
+ * modified through get<T>(), but cannot change its alternative in place;
+ * the container grows and shrinks at the back only.
+ *
+ * The column of bools holds bool_cells, one byte each, rather than being a
+ * bit packed std::vector<bool>.
+ */
+template <typename... Types>
+class variant_vector
+{
+    static_assert(sizeof...(Types) > 0, "Template parameter type list of variant_vector can not be empty.");
+    static_assert(sizeof...(Types) <= 255, "variant_vector supports at most 255 alternatives.");
+
+public:
+    using value_type = variant<Types...>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using tag_type = std::uint8_t;
+    using offset_type = std::uint32_t;
+
+    // A bool taking a byte, stored for bool alternatives so that their
+    // column is not a bit packed std::vector<bool>. Its value member holds
+    // the bool.
+    using bool_cell = detail::bool_cell;
+
+    // Type stored for the I-th alternative: the alternative itself, or
+    // bool_cell for bool.
+    template <std::size_t I>
+    using cell_type = typename detail::vector_column<typename std::tuple_element<I, std::tuple<Types...>>::type>::type;
+
+    template <std::size_t I>
+    using column_type = std::vector<cell_type<I>>;
+
+private:
+    using first_type = typename std::tuple_element<0, std::tuple<Types...>>::type;
+
+    template <typename T>
+    using alternative = detail::alternative_of<T, Types...>;
+
+    template <typename T>
+    using enable_if_alternative = typename std::enable_if<alternative<T>::is_valid>::type;
+
+    template <std::size_t I>
+    using type_at = typename std::tuple_element<I, std::tuple<Types...>>::type;
+
+    template <bool Const, typename T>
+    using qualified = typename std::conditional<Const, T const, T>::type;
+
+    template <bool Const>
+    using self = qualified<Const, variant_vector>;
+
+    template <bool Const>
+    class basic_iterator;
+
+public:
+    /**
+     * Proxy for an element. Like a pointer, a const proxy of a non-const
+     * container still gives non-const access to the element.
+     */
+    template <bool Const>
+    class basic_reference
+    {
+    public:
+        basic_reference(self<Const>& container, size_type index) noexcept
+            : container_(&container), index_(index) {}
+
+        // Converts a reference to non-const elements to one to const elements.
+        template <bool C = Const, typename = typename std::enable_if<C>::type>
+        basic_reference(basic_reference<false> const& other) noexcept
+            : container_(other.container_), index_(other.index_) {}
+
+        int which() const noexcept
+        {
+            return container_->tags_[index_];
+        }
+
+        template <typename T, typename = enable_if_alternative<T>>
+        bool is() const noexcept
+        {
+            return container_->tags_[index_] == alternative<T>::index;
+        }
+
+        template <typename T, typename = enable_if_alternative<T>>
+        qualified<Const, T>& get_unchecked() const
+        {
+            return container_->template value<T>(index_);
+        }
+
+#ifdef HAS_EXCEPTIONS
+        template <typename T, typename = enable_if_alternative<T>>
+        qualified<Const, T>& get() const
+        {
+            if (!is<T>())
+            {
+                throw bad_variant_access("in get<T>()");
+            }
+            return container_->template value<T>(index_);
+        }
+#endif
+
+        template <typename F, typename R = typename detail::result_of_unary_visit<F, first_type>::type>
+        static R visit(basic_reference const& r, F&& f)
+        {
+            return r.container_->template visit<R>(r.index_, std::forward<F>(f));
+        }
+
+        template <typename... Fs>
+        auto match(Fs&&... fs) const
+            -> decltype(visit(*this, ::mapbox::util::make_visitor(std::forward<Fs>(fs)...)))
+        {
+            return visit(*this, ::mapbox::util::make_visitor(std::forward<Fs>(fs)...));
+        }
+
+        // Copies the element into a variant.
+        operator value_type() const
+        {
+            return container_->at_variant(index_);
+        }
+
+        size_type index() const noexcept { return index_; }
+
+    private:
+        friend class basic_reference<true>;
+        friend class basic_iterator<Const>;
+
+        basic_reference(self<Const>* container, size_type index) noexcept
+            : container_(container), index_(index) {}
+
+        self<Const>* container_;
+        size_type index_;
+    };
+
+    using reference = basic_reference<false>;
+    using const_reference = basic_reference<true>;
+
+private:
+    // Random access iterator yielding proxies, in the same way as the
+    // iterators of std::vector<bool>.
+    template <bool Const>
+    class basic_iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = variant<Types...>;
+        using difference_type = std::ptrdiff_t;
+        using reference = basic_reference<Const>;
+        using pointer = void;
+
+        basic_iterator() noexcept
+            : ref_(nullptr, 0) {}
+
+        basic_iterator(self<Const>* container, size_type index) noexcept
+            : ref_(container, index) {}
+
+        template <bool C = Const, typename = typename std::enable_if<C>::type>
+        basic_iterator(basic_iterator<false> const& other) noexcept
+            : ref_(other.ref_) {}
+
+        reference operator*() const noexcept { return ref_; }
+        reference operator[](difference_type n) const noexcept { return *(*this + n); }
+
+        basic_iterator& operator++() noexcept { ++ref_.index_; return *this; }
+        basic_iterator& operator--() noexcept { --ref_.index_; return *this; }
+        basic_iterator operator++(int) noexcept { basic_iterator it(*this); ++ref_.index_; return it; }
+        basic_iterator operator--(int) noexcept { basic_iterator it(*this); --ref_.index_; return it; }
+
+        basic_iterator& operator+=(difference_type n) noexcept
+        {
+            ref_.index_ = static_cast<size_type>(static_cast<difference_type>(ref_.index_) + n);
+            return *this;
+        }
+
+        basic_iterator& operator-=(difference_type n) noexcept { return *this += -n; }
+        basic_iterator operator+(difference_type n) const noexcept { return basic_iterator(*this) += n; }
+        basic_iterator operator-(difference_type n) const noexcept { return basic_iterator(*this) -= n; }
+        friend basic_iterator operator+(difference_type n, basic_iterator const& it) noexcept { return it + n; }
+
+        // Iterators and const iterators mix, as the former convert to the latter.
+        friend difference_type operator-(basic_iterator const& a, basic_iterator const& b) noexcept
+        {
+            return static_cast<difference_type>(a.ref_.index()) - static_cast<difference_type>(b.ref_.index());
+        }
+
+        friend bool operator==(basic_iterator const& a, basic_iterator const& b) noexcept { return a.ref_.index() == b.ref_.index(); }
+        friend bool operator!=(basic_iterator const& a, basic_iterator const& b) noexcept { return a.ref_.index() != b.ref_.index(); }
+        friend bool operator<(basic_iterator const& a, basic_iterator const& b) noexcept { return a.ref_.index() < b.ref_.index(); }
+        friend bool operator>(basic_iterator const& a, basic_iterator const& b) noexcept { return a.ref_.index() > b.ref_.index(); }
+        friend bool operator<=(basic_iterator const& a, basic_iterator const& b) noexcept { return a.ref_.index() <= b.ref_.index(); }
+        friend bool operator>=(basic_iterator const& a, basic_iterator const& b) noexcept { return a.ref_.index() >= b.ref_.index(); }
+
+    private:
+        friend class basic_iterator<true>;
+
+        basic_reference<Const> ref_;
+    };
+
+public:
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    variant_vector() = default;
+
+    // Zero based tag of the alternative holding a T.
+    template <typename T, typename = enable_if_alternative<T>>
+    static constexpr tag_type tag_of() noexcept
+    {
+        return static_cast<tag_type>(alternative<T>::index);
+    }
+
+    size_type size() const noexcept { return tags_.size(); }
+    bool empty() const noexcept { return tags_.empty(); }
+
+    size_type max_size() const noexcept
+    {
+        return std::numeric_limits<offset_type>::max();
+    }
+
+    // Reserves room for n elements in the tag and offset columns. The
+    // values are stored in per-alternative columns, which grow as needed.
+    void reserve(size_type n)
+    {
+        tags_.reserve(n);
+        offsets_.reserve(n);
+    }
+
+    void clear() noexcept
+    {
+        tags_.clear();
+        offsets_.clear();
+        clear_columns(detail::make_index_sequence<sizeof...(Types)>());
+    }
+
+    // Replaces the elements by n value initialized ones, the i-th of the
+    // alternative with tag tag_at(i). Their values can then be written
+    // through values<I>(). The memory of the container is reused. Throws
+    // std::length_error if n is more than max_size() and
+    // std::invalid_argument if a tag is not that of an alternative. If that
+    // happens, or tag_at or constructing a value throws, the container is
+    // left empty.
+    template <typename F>
+    void assign_tags(size_type n, F&& tag_at)
+    {
+        clear_guard guard{this};
+        if (n > max_size())
+        {
+#ifdef HAS_EXCEPTIONS
+            throw std::length_error("variant_vector: too many elements");
+#else
+            assert(false);
+            return;
+#endif
+        }
+        tags_.resize(n);
+        offsets_.resize(n);
+        // Through pointers, as tag stores could otherwise alias the vectors.
+        tag_type* const tags = tags_.data();
+        offset_type* const offsets = offsets_.data();
+        for (size_type i = 0; i < n; ++i)
+        {
+            auto const tag = tag_at(i);
+            if (!is_alternative_tag(tag, std::is_signed<decltype(tag)>()))
+            {
+#ifdef HAS_EXCEPTIONS
+                throw std::invalid_argument("variant_vector: tag of no alternative");
+#else
+                assert(false);
+                return;
+#endif
+            }
+            tags[i] = static_cast<tag_type>(tag);
+        }
+        std::size_t counts[sizeof...(Types)] = {};
+        // Numbers runs of equal tags at once, rather than one count update
+        // after the other.
+        for (size_type i = 0; i < n;)
+        {
+            tag_type const tag = tags[i];
+            size_type end = i + 1;
+            while (end < n && tags[end] == tag)
+            {
+                ++end;
+            }
+            offset_type const first = static_cast<offset_type>(counts[tag] - i);
+            for (size_type j = i; j < end; ++j)
+            {
+                offsets[j] = static_cast<offset_type>(first + j);
+            }
+            counts[tag] += end - i;
+            i = end;
+        }
+        clear_columns(detail::make_index_sequence<sizeof...(Types)>());
+        resize_columns(counts, detail::make_index_sequence<sizeof...(Types)>());
+        guard.self = nullptr;
+    }
+
+    reference operator[](size_type i) noexcept { return reference(*this, i); }
+    const_reference operator[](size_type i) const noexcept { return const_reference(*this, i); }
+
+    reference back() noexcept { return (*this)[size() - 1]; }
+    const_reference back() const noexcept { return (*this)[size() - 1]; }
+
+    iterator begin() noexcept { return iterator(this, 0); }
+    iterator end() noexcept { return iterator(this, size()); }
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator end() const noexcept { return const_iterator(this, size()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    // Appends a T constructed from args, where T is an alternative or the
+    // type wrapped by one, and returns the value it holds, unwrapped.
+    template <typename T, typename... Args, typename = enable_if_alternative<T>>
+    typename alternative<T>::value_type& emplace_back(Args&&... args)
+    {
+        using stored_type = typename alternative<T>::type;
+        return detail::unwrapper<stored_type>::apply(append_value<alternative<T>::index>(std::forward<Args>(args)...));
+    }
+
+    template <typename T, typename Value = typename std::remove_cv<typename std::remove_reference<T>::type>::type,
+              typename = enable_if_alternative<Value>>
+    void push_back(T&& value)
+    {
+        emplace_back<Value>(std::forward<T>(value));
+    }
+
+    void push_back(value_type const& v)
+    {
+        push_variant(v, detail::make_index_sequence<sizeof...(Types)>());
+    }
+
+    void push_back(value_type&& v)
+    {
+        push_variant(std::move(v), detail::make_index_sequence<sizeof...(Types)>());
+    }
+
+    // Appends the values of the range [first, last) as Ts. Appending a run
+    // of values of one alternative copies them into its column at once.
+    template <typename T, typename ForwardIt, typename = enable_if_alternative<T>,
+              typename = typename std::enable_if<!std::is_integral<ForwardIt>::value>::type>
+    void append(ForwardIt first, ForwardIt last)
+    {
+        constexpr std::size_t I = alternative<T>::index;
+        size_type const n = static_cast<size_type>(std::distance(first, last));
+        offset_type offset = 0;
+        if (!make_run_room<I>(n, offset))
+        {
+            return;
+        }
+        std::get<I>(columns_).insert(std::get<I>(columns_).end(), first, last);
+        push_run<I>(offset, n);
+    }
+
+    // Appends n copies of value.
+    template <typename T, typename = enable_if_alternative<T>>
+    void append(size_type n, T const& value)
+    {
+        constexpr std::size_t I = alternative<T>::index;
+        offset_type offset = 0;
+        if (!make_run_room<I>(n, offset))
+        {
+            return;
+        }
+        std::get<I>(columns_).insert(std::get<I>(columns_).end(), n, value);
+        push_run<I>(offset, n);
+    }
+
+    void pop_back()
+    {
+        assert(!empty());
+        pop(detail::make_index_sequence<sizeof...(Types)>());
+        tags_.pop_back();
+        offsets_.pop_back();
+    }
+
+    // The tag of each element, the zero based index of its alternative.
+    std::vector<tag_type> const& tags() const noexcept { return tags_; }
+
+    // The position of each element in the column of its alternative.
+    std::vector<offset_type> const& offsets() const noexcept { return offsets_; }
+
+    // The values of the I-th alternative, in the order of the elements.
+    template <std::size_t I>
+    column_type<I> const& column() const noexcept { return std::get<I>(columns_); }
+
+    // The values of the I-th alternative, to be modified in place.
+    template <std::size_t I>
+    column_span<cell_type<I>> values() noexcept
+    {
+        column_type<I>& column = std::get<I>(columns_);
+        return {column.data(), column.size()};
+    }
+
+private:
+    // Empties the container on destruction unless self is reset, so that
+    // an exception thrown while it is rebuilt leaves no tags indexing into
+    // missing values.
+    struct clear_guard
+    {
+        variant_vector* self;
+
+        ~clear_guard()
+        {
+            if (self != nullptr)
+            {
+                self->clear();
+            }
+        }
+    };
+
+    // Whether a tag returned to assign_tags names an alternative, checked
+    // before it is narrowed to tag_type.
+    template <typename T>
+    static bool is_alternative_tag(T tag, std::true_type) noexcept
+    {
+        return tag >= 0 && static_cast<typename std::make_unsigned<T>::type>(tag) < sizeof...(Types);
+    }
+
+    template <typename T>
+    static bool is_alternative_tag(T tag, std::false_type) noexcept
+    {
+        return tag < sizeof...(Types);
+    }
+
+    template <std::size_t I>
+    type_at<I>& element(offset_type offset)
+    {
+        return detail::vector_column<type_at<I>>::get(std::get<I>(columns_)[offset]);
+    }
+
+    template <std::size_t I>
+    type_at<I> const& element(offset_type offset) const
+    {
+        return detail::vector_column<type_at<I>>::get(std::get<I>(columns_)[offset]);
+    }
+
+    template <typename T>
+    T& value(size_type i)
+    {
+        assert(tags_[i] == alternative<T>::index);
+        using stored_type = typename alternative<T>::type;
+        return detail::unwrapper<stored_type>::apply(element<alternative<T>::index>(offsets_[i]));
+    }
+
+    template <typename T>
+    T const& value(size_type i) const
+    {
+        assert(tags_[i] == alternative<T>::index);
+        using stored_type = typename alternative<T>::type;
+        return detail::unwrapper<stored_type>::apply_const(element<alternative<T>::index>(offsets_[i]));
+    }
+
+    template <typename R, typename F, std::size_t I>
+    static R invoke(variant_vector& v, offset_type offset, F&& f)
+    {
+        return f(detail::unwrapper<type_at<I>>::apply(v.template element<I>(offset)));
+    }
+
+    template <typename R, typename F, std::size_t I>
+    static R invoke_const(variant_vector const& v, offset_type offset, F&& f)
+    {
+        return f(detail::unwrapper<type_at<I>>::apply_const(v.template element<I>(offset)));
+    }
+
+    template <typename R, typename F, std::size_t... Is>
+    R visit(size_type i, F&& f, detail::index_sequence<Is...>)
+    {
+        using function_type = R (*)(variant_vector&, offset_type, F&&);
+        static constexpr function_type table[] = {&invoke<R, F, Is>...};
+        return table[tags_[i]](*this, offsets_[i], std::forward<F>(f));
+    }
+
+    template <typename R, typename F, std::size_t... Is>
+    R visit(size_type i, F&& f, detail::index_sequence<Is...>) const
+    {
+        using function_type = R (*)(variant_vector const&, offset_type, F&&);
+        static constexpr function_type table[] = {&invoke_const<R, F, Is>...};
+        return table[tags_[i]](*this, offsets_[i], std::forward<F>(f));
+    }
+
+    template <typename R, typename F>
+    R visit(size_type i, F&& f)
+    {
+        return visit<R>(i, std::forward<F>(f), detail::make_index_sequence<sizeof...(Types)>());
+    }
+
+    template <typename R, typename F>
+    R visit(size_type i, F&& f) const
+    {
+        return visit<R>(i, std::forward<F>(f), detail::make_index_sequence<sizeof...(Types)>());
+    }
+
+    // Constructed by type, since the variant can only hold the first of
+    // duplicated alternatives.
+    template <std::size_t I>
+    static value_type make_variant(variant_vector const& v, offset_type offset)
+    {
+        return value_type(in_place_type_t<type_at<I>>{}, v.template element<I>(offset));
+    }
+
+    template <std::size_t... Is>
+    value_type at_variant(size_type i, detail::index_sequence<Is...>) const
+    {
+        using function_type = value_type (*)(variant_vector const&, offset_type);
+        static constexpr function_type table[] = {&make_variant<Is>...};
+        return table[tags_[i]](*this, offsets_[i]);
+    }
+
+    value_type at_variant(size_type i) const
+    {
+        return at_variant(i, detail::make_index_sequence<sizeof...(Types)>());
+    }
+
+    // Grows the tag and offset columns geometrically ahead of appending n
+    // elements, so that appending to them afterwards cannot throw.
+    template <typename T>
+    static void make_room(std::vector<T>& column, size_type n)
+    {
+        if (column.capacity() - column.size() < n)
+        {
+            column.reserve(std::max(column.size() + n, column.empty() ? size_type(8) : 2 * column.size()));
+        }
+    }
+
+    // Appends a value to the I-th column and the element to the tag and
+    // offset columns. If constructing the value throws, nothing changes.
+    // Without exceptions a column that is full aborts, as there is no value
+    // to return a reference to.
+    template <std::size_t I, typename... Args>
+    type_at<I>& append_value(Args&&... args)
+    {
+        column_type<I>& column = std::get<I>(columns_);
+        if (tags_.size() >= max_size())
+        {
+#ifdef HAS_EXCEPTIONS
+            throw std::length_error("variant_vector: too many elements");
+#else
+            assert(false);
+            std::abort();
+#endif
+        }
+        make_room(tags_, 1);
+        make_room(offsets_, 1);
+        column.emplace_back(std::forward<Args>(args)...);
+        tags_.push_back(static_cast<tag_type>(I));
+        offsets_.push_back(static_cast<offset_type>(column.size() - 1));
+        return detail::vector_column<type_at<I>>::get(column.back());
+    }
+
+    // Makes room for n more values of the I-th alternative and sets offset
+    // to that of the first. Returns false, without exceptions, if they do
+    // not fit. No column is longer than the tag column, so checking that
+    // one keeps the offsets in range too.
+    template <std::size_t I>
+    bool make_run_room(size_type n, offset_type& offset)
+    {
+        column_type<I> const& column = std::get<I>(columns_);
+        if (n > max_size() - tags_.size())
+        {
+#ifdef HAS_EXCEPTIONS
+            throw std::length_error("variant_vector: too many elements");
+#else
+            assert(false);
+            return false;
+#endif
+        }
+        make_room(tags_, n);
+        make_room(offsets_, n);
+        offset = static_cast<offset_type>(column.size());
+        return true;
+    }
+
+    // Adds the tags and offsets of n values appended to the I-th column.
+    template <std::size_t I>
+    void push_run(offset_type offset, size_type n)
+    {
+        tags_.insert(tags_.end(), n, static_cast<tag_type>(I));
+        size_type const first = offsets_.size();
+        offsets_.resize(first + n);
+        offset_type* const offsets = offsets_.data() + first;
+        for (size_type i = 0; i < n; ++i)
+        {
+            offsets[i] = static_cast<offset_type>(offset + i);
+        }
+    }
+
+    template <std::size_t I>
+    static void push_copy(variant_vector& self, value_type const& v)
+    {
+        self.append_value<I>(v.template get_unchecked<type_at<I>>());
+    }
+
+    template <std::size_t I>
+    static void push_move(variant_vector& self, value_type& v)
+    {
+        self.append_value<I>(std::move(v.template get_unchecked<type_at<I>>()));
+    }
+
+    template <std::size_t... Is>
+    void push_variant(value_type const& v, detail::index_sequence<Is...>)
+    {
+        using function_type = void (*)(variant_vector&, value_type const&);
+        static constexpr function_type table[] = {&push_copy<Is>...};
+        assert(v.valid());
+        table[static_cast<std::size_t>(v.which())](*this, v);
+    }
+
+    template <std::size_t... Is>
+    void push_variant(value_type&& v, detail::index_sequence<Is...>)
+    {
+        using function_type = void (*)(variant_vector&, value_type&);
+        static constexpr function_type table[] = {&push_move<Is>...};
+        assert(v.valid());
+        table[static_cast<std::size_t>(v.which())](*this, v);
+    }
+
+    // The last element is the last value of its column, as elements are
+    // only added and removed at the back.
+    template <std::size_t I>
+    static void pop_value(variant_vector& self)
+    {
+        std::get<I>(self.columns_).pop_back();
+    }
+
+    template <std::size_t... Is>
+    void pop(detail::index_sequence<Is...>)
+    {
+        using function_type = void (*)(variant_vector&);
+        static constexpr function_type table[] = {&pop_value<Is>...};
+        table[tags_.back()](*this);
+    }
+
+    template <std::size_t... Is>
+    void resize_columns(std::size_t const* sizes, detail::index_sequence<Is...>)
+    {
+        int expand[] = {(std::get<Is>(columns_).resize(sizes[Is]), 0)...};
+        (void)expand;
+    }
+
+    template <std::size_t... Is>
+    void clear_columns(detail::index_sequence<Is...>) noexcept
+    {
+        int expand[] = {(std::get<Is>(columns_).clear(), 0)...};
+        (void)expand;
+    }
+
+    std::vector<tag_type> tags_;
+    std::vector<offset_type> offsets_;
+    std::tuple<std::vector<typename detail::vector_column<Types>::type>...> columns_;
+};
+
+} // namespace util
+} // namespace mapbox
+
+#endif // MAPBOX_UTIL_VARIANT_VECTOR_HPP
@@ -30,3 +30,5 @@ build\variant.sln ^
 /p:Platform=%MSBUILD_PLATFORM%
 
 build\"%configuration%"\tests.exe
+build\"%configuration%"\instrumentation_tests.exe
+build\"%configuration%"\allocation_tracker_tests.exe
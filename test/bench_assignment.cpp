@@ -0,0 +1,147 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "auto_cpu_timer.hpp"
+
+#include <mapbox/variant.hpp>
+
+#define TEXT_SHORT "Test"
+#define TEXT_LONG "Testing various variant implementations with a longish string ........................................."
+
+using namespace mapbox;
+
+using variant_type = util::variant<int, double, std::string>;
+
+// Keeps the compiler from optimizing the assignments away.
+std::size_t checksum(variant_type const& v)
+{
+    return v.is<std::string>() ? v.get_unchecked<std::string>().size() : 1;
+}
+
+std::size_t assign_string(std::vector<std::string> const& values, std::size_t num_iter)
+{
+    std::size_t total = 0;
+    std::string s{TEXT_LONG};
+    for (std::size_t i = 0; i < num_iter; ++i)
+    {
+        s = values[i % values.size()];
+        total += s.size();
+    }
+    return total;
+}
+
+std::size_t assign_value(std::vector<std::string> const& values, std::size_t num_iter)
+{
+    std::size_t total = 0;
+    variant_type v{std::string(TEXT_LONG)};
+    for (std::size_t i = 0; i < num_iter; ++i)
+    {
+        v = values[i % values.size()];
+        total += checksum(v);
+    }
+    return total;
+}
+
+std::size_t assign_variant(std::vector<variant_type> const& values, std::size_t num_iter)
+{
+    std::size_t total = 0;
+    variant_type v{std::string(TEXT_LONG)};
+    for (std::size_t i = 0; i < num_iter; ++i)
+    {
+        v = values[i % values.size()];
+        total += checksum(v);
+    }
+    return total;
+}
+
+// Every assignment changes the type: a string, then an int, and so on.
+std::size_t assign_other_type(std::vector<std::string> const& values, std::size_t num_iter)
+{
+    std::size_t total = 0;
+    variant_type v{0};
+    for (std::size_t i = 0; i < num_iter; ++i)
+    {
+        if (i % 2 == 0)
+        {
+            v = values[i % values.size()];
+        }
+        else
+        {
+            v = static_cast<int>(i);
+        }
+        total += checksum(v);
+    }
+    return total;
+}
+
+// Same, with the strings built as temporaries and moved in.
+std::size_t assign_other_type_rvalue(std::vector<std::string> const& values, std::size_t num_iter)
+{
+    std::size_t total = 0;
+    variant_type v{0};
+    for (std::size_t i = 0; i < num_iter; ++i)
+    {
+        if (i % 2 == 0)
+        {
+            v = std::string(values[i % values.size()]);
+        }
+        else
+        {
+            v = static_cast<int>(i);
+        }
+        total += checksum(v);
+    }
+    return total;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage" << argv[0] << " <num-iter>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::size_t NUM_ITER = static_cast<std::size_t>(std::stol(argv[1])) * 100;
+
+    std::vector<std::string> const strings{TEXT_SHORT, TEXT_LONG};
+    std::vector<variant_type> const same_type{std::string(TEXT_SHORT), std::string(TEXT_LONG)};
+    std::vector<variant_type> const mixed_types{std::string(TEXT_LONG), 42, 3.14};
+
+    std::size_t total = 0;
+    {
+        std::cerr << "std::string = std::string: ";
+        auto_cpu_timer t;
+        total += assign_string(strings, NUM_ITER);
+    }
+    {
+        std::cerr << "variant = std::string: ";
+        auto_cpu_timer t;
+        total += assign_value(strings, NUM_ITER);
+    }
+    {
+        std::cerr << "variant = std::string / int (changing type): ";
+        auto_cpu_timer t;
+        total += assign_other_type(strings, NUM_ITER);
+    }
+    {
+        std::cerr << "variant = std::string&& / int (changing type): ";
+        auto_cpu_timer t;
+        total += assign_other_type_rvalue(strings, NUM_ITER);
+    }
+    {
+        std::cerr << "variant = variant (same type): ";
+        auto_cpu_timer t;
+        total += assign_variant(same_type, NUM_ITER);
+    }
+    {
+        std::cerr << "variant = variant (mixed types): ";
+        auto_cpu_timer t;
+        total += assign_variant(mixed_types, NUM_ITER);
+    }
+    std::cerr << "checksum " << total << std::endl;
+
+    return EXIT_SUCCESS;
+}
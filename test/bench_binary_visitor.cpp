@@ -0,0 +1,121 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "auto_cpu_timer.hpp"
+
+#include <mapbox/variant.hpp>
+
+using namespace mapbox;
+
+namespace test {
+
+struct javascript_equal_visitor
+{
+    template <typename T>
+    bool operator()(T lhs, T rhs) const
+    {
+        return lhs == rhs;
+    }
+
+    template <typename T0, typename T1>
+    bool operator()(T0 lhs, T1 rhs) const
+    {
+        return lhs == static_cast<T0>(rhs);
+    }
+};
+
+template <typename Dispatcher, typename V>
+std::size_t count_equal(std::vector<V> const& lhs, std::vector<V> const& rhs, std::size_t num_iter)
+{
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < num_iter; ++i)
+    {
+        for (std::size_t j = 0; j < lhs.size(); ++j)
+        {
+            count += Dispatcher::apply_const(lhs[j], rhs[j], javascript_equal_visitor()) ? 1u : 0u;
+        }
+    }
+    return count;
+}
+
+} // namespace test
+
+template <typename V, typename T>
+V make_value(std::size_t, std::int64_t value)
+{
+    return V(static_cast<T>(value));
+}
+
+template <typename V, typename T0, typename T1, typename... Types>
+V make_value(std::size_t which, std::int64_t value)
+{
+    return which == 0 ? V(static_cast<T0>(value)) : make_value<V, T1, Types...>(which - 1, value);
+}
+
+template <typename... Types>
+void run(std::string const& name, std::size_t num_iter, bool same_type)
+{
+    using variant_type = util::variant<Types...>;
+    using visitor_type = test::javascript_equal_visitor&&;
+    using chain = util::detail::binary_dispatcher<visitor_type, variant_type, bool, Types...>;
+    using table = util::detail::binary_table_dispatcher<visitor_type, variant_type, bool, Types...>;
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<std::size_t> which(0, sizeof...(Types)-1);
+    std::uniform_int_distribution<std::int64_t> value(0, 3);
+
+    std::vector<variant_type> lhs;
+    std::vector<variant_type> rhs;
+    for (std::size_t i = 0; i < 100000; ++i)
+    {
+        std::size_t const w = which(gen);
+        lhs.push_back(make_value<variant_type, Types...>(w, value(gen)));
+        rhs.push_back(make_value<variant_type, Types...>(same_type ? w : which(gen), value(gen)));
+    }
+
+    std::cerr << name << (same_type ? " same type" : " mixed types") << std::endl;
+    std::size_t total_chain = 0;
+    std::size_t total_table = 0;
+    {
+        std::cerr << "  chain: ";
+        auto_cpu_timer t;
+        total_chain = test::count_equal<chain>(lhs, rhs, num_iter);
+    }
+    {
+        std::cerr << "  table: ";
+        auto_cpu_timer t;
+        total_table = test::count_equal<table>(lhs, rhs, num_iter);
+    }
+    if (total_chain != total_table)
+    {
+        std::cerr << "mismatch " << total_chain << " != " << total_table << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage" << argv[0] << " <num-iter>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::size_t NUM_ITER = static_cast<std::size_t>(std::stol(argv[1])) / 100000 + 1;
+
+    for (bool same_type : {true, false})
+    {
+        run<bool, std::int64_t, std::uint64_t, double>("4 alternatives", NUM_ITER, same_type);
+        run<bool, std::int64_t, std::uint64_t, double,
+            float, std::int32_t, std::uint32_t, std::int16_t>("8 alternatives", NUM_ITER, same_type);
+        run<bool, std::int64_t, std::uint64_t, double,
+            float, std::int32_t, std::uint32_t, std::int16_t,
+            std::uint16_t, std::int8_t, std::uint8_t, long double>("12 alternatives", NUM_ITER, same_type);
+    }
+
+    return EXIT_SUCCESS;
+}
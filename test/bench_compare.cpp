@@ -0,0 +1,163 @@
+// Compares mapbox::util::variant with std::variant and, when it is
+// available, boost::variant, using the harness in bench.hpp.
+
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench.hpp"
+
+#include <mapbox/variant.hpp>
+
+#if defined(__has_include)
+#if __cplusplus >= 201703L && __has_include(<variant>)
+#include <variant>
+#define HAVE_STD_VARIANT
+#endif
+#if __has_include(<boost/variant.hpp>)
+#include <boost/variant.hpp>
+#define HAVE_BOOST_VARIANT
+#endif
+#endif
+
+namespace test {
+
+#define TEXT_SHORT "Test"
+#define TEXT_LONG "Testing various variant implementations with a longish string ........................................."
+
+struct mapbox_variant
+{
+    static constexpr char const* name = "mapbox";
+
+    template <typename... Types>
+    using variant = mapbox::util::variant<Types...>;
+
+    template <typename F, typename V>
+    static typename F::result_type visit(F const& f, V const& v)
+    {
+        return mapbox::util::apply_visitor(f, v);
+    }
+};
+
+#ifdef HAVE_STD_VARIANT
+struct std_variant
+{
+    static constexpr char const* name = "std";
+
+    template <typename... Types>
+    using variant = std::variant<Types...>;
+
+    template <typename F, typename V>
+    static typename F::result_type visit(F const& f, V const& v)
+    {
+        return std::visit(f, v);
+    }
+};
+#endif
+
+#ifdef HAVE_BOOST_VARIANT
+struct boost_variant
+{
+    static constexpr char const* name = "boost";
+
+    template <typename... Types>
+    using variant = boost::variant<Types...>;
+
+    template <typename F, typename V>
+    static typename F::result_type visit(F const& f, V const& v)
+    {
+        return boost::apply_visitor(f, v);
+    }
+};
+#endif
+
+struct measure
+{
+    using result_type = std::size_t;
+
+    std::size_t operator()(int value) const { return static_cast<std::size_t>(value); }
+    std::size_t operator()(double value) const { return static_cast<std::size_t>(value); }
+    std::size_t operator()(std::string const& value) const { return value.size(); }
+};
+
+template <typename Lib>
+using value_type = typename Lib::template variant<int, double, std::string>;
+
+// The values cycle through the alternatives and both string lengths, so
+// that dispatch cannot be predicted from a single type.
+template <typename Lib>
+std::vector<value_type<Lib>> make_values(std::size_t count)
+{
+    std::vector<value_type<Lib>> values;
+    values.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        switch (i % 4)
+        {
+        case 0: values.emplace_back(std::string(TEXT_SHORT)); break;
+        case 1: values.emplace_back(std::string(TEXT_LONG)); break;
+        case 2: values.emplace_back(123); break;
+        default: values.emplace_back(3.14159); break;
+        }
+    }
+    return values;
+}
+
+template <typename Lib>
+void run(bench::runner& runner)
+{
+    std::size_t const n = runner.config().iterations;
+    std::string const prefix = std::string(Lib::name) + "/";
+    std::vector<value_type<Lib>> const values = make_values<Lib>(n);
+
+    runner.run(prefix + "construct", [n] {
+        bench::do_not_optimize(make_values<Lib>(n));
+    });
+
+    runner.run(prefix + "visit", [&values] {
+        std::size_t total = 0;
+        for (auto const& v : values)
+        {
+            total += Lib::visit(measure(), v);
+        }
+        bench::do_not_optimize(total);
+    });
+
+    runner.run(prefix + "copy", [&values] {
+        std::vector<value_type<Lib>> copy(values);
+        bench::do_not_optimize(copy);
+    });
+
+    runner.run(prefix + "assign", [&values] {
+        value_type<Lib> v;
+        for (auto const& value : values)
+        {
+            v = value;
+            bench::do_not_optimize(v);
+        }
+    });
+}
+
+} // namespace test
+
+int main(int argc, char** argv)
+{
+    bench::options opts;
+    if (!opts.parse(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+    bench::runner runner(opts);
+
+    test::run<test::mapbox_variant>(runner);
+#ifdef HAVE_STD_VARIANT
+    test::run<test::std_variant>(runner);
+#endif
+#ifdef HAVE_BOOST_VARIANT
+    test::run<test::boost_variant>(runner);
+#endif
+
+    return runner.finish();
+}
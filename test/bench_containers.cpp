@@ -0,0 +1,215 @@
+// Compares visiting every value of a large sequence of variants kept in a
+// std::vector of variants, a variant_vector and a variant_collection, with
+// the types of consecutive values in a random or a sorted order. Also
+// reports the memory each container takes per value, and compares the tag
+// algorithms with loops over which().
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+#include <mapbox/tag_algorithms.hpp>
+#include <mapbox/variant.hpp>
+#include <mapbox/variant_collection.hpp>
+#include <mapbox/variant_vector.hpp>
+
+using namespace mapbox;
+
+namespace test {
+
+using variant_type = util::variant<std::int32_t, double, std::string>;
+using vector_type = util::variant_vector<std::int32_t, double, std::string>;
+using collection_type = util::variant_collection<std::int32_t, double, std::string>;
+
+struct sum
+{
+    double operator()(std::int32_t i) const { return i; }
+    double operator()(double d) const { return d; }
+    double operator()(std::string const& s) const { return static_cast<double>(s.size()); }
+};
+
+struct accumulate
+{
+    double total = 0;
+
+    template <typename T>
+    void operator()(T const& value)
+    {
+        total += sum()(value);
+    }
+};
+
+// Mostly numbers, as in a column of attributes.
+std::vector<variant_type> make_values(std::size_t count, bool sorted)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<variant_type> values;
+    values.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        int const p = sorted ? static_cast<int>(i * 100 / count) : percent(gen);
+        if (p < 60)
+        {
+            values.emplace_back(static_cast<std::int32_t>(i));
+        }
+        else if (p < 95)
+        {
+            values.emplace_back(static_cast<double>(i) * 0.5);
+        }
+        else
+        {
+            values.emplace_back(std::string("name"));
+        }
+    }
+    return values;
+}
+
+void run(bench::runner& runner, bool sorted)
+{
+    std::size_t const count = runner.config().iterations;
+    std::vector<variant_type> const values = make_values(count, sorted);
+    vector_type vector;
+    collection_type collection;
+    vector.reserve(count);
+    for (variant_type const& v : values)
+    {
+        vector.push_back(v);
+        collection.insert(v);
+    }
+
+    std::string const prefix = sorted ? "sorted/" : "random/";
+
+    runner.run(prefix + "std::vector<variant>", [&values] {
+        double total = 0;
+        for (variant_type const& v : values)
+        {
+            total += util::apply_visitor(sum(), v);
+        }
+        bench::do_not_optimize(total);
+    });
+
+    runner.run(prefix + "variant_vector", [&vector] {
+        double total = 0;
+        for (vector_type::const_reference v : vector)
+        {
+            total += util::apply_visitor(sum(), v);
+        }
+        bench::do_not_optimize(total);
+    });
+
+    runner.run(prefix + "variant_collection", [&collection] {
+        accumulate a;
+        collection.for_each(a);
+        bench::do_not_optimize(a.total);
+    });
+}
+
+void run_tags(bench::runner& runner)
+{
+    std::size_t const count = runner.config().iterations;
+    std::vector<variant_type> const values = make_values(count, false);
+    vector_type vector;
+    vector.reserve(count);
+    for (variant_type const& v : values)
+    {
+        vector.push_back(v);
+    }
+
+    std::string const prefix = std::string("tags/") + util::tag_simd_instruction_set() + "/";
+
+    runner.run(prefix + "count/which()", [&values] {
+        std::size_t n = 0;
+        for (variant_type const& v : values)
+        {
+            n += v.which() == 2;
+        }
+        bench::do_not_optimize(n);
+    });
+
+    runner.run(prefix + "count/variant_vector", [&vector] {
+        bench::do_not_optimize(util::count_alternative<std::string>(vector));
+    });
+
+    runner.run(prefix + "count/std::vector<variant>", [&values] {
+        bench::do_not_optimize(util::count_alternative<std::string>(values));
+    });
+
+    runner.run(prefix + "mask/which()", [&values] {
+        util::tag_bitmask mask((values.size() + 63) / 64);
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            mask[i / 64] |= static_cast<std::uint64_t>(values[i].which() == 2) << (i % 64);
+        }
+        bench::do_not_optimize(mask.data());
+    });
+
+    runner.run(prefix + "mask/variant_vector", [&vector] {
+        util::tag_bitmask const mask = util::alternative_mask<std::string>(vector);
+        bench::do_not_optimize(mask.data());
+    });
+
+    runner.run(prefix + "partition/which()", [&values] {
+        util::tag_permutation positions;
+        positions.reserve(values.size());
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            for (std::size_t i = 0; i < values.size(); ++i)
+            {
+                if ((values[i].which() == 2) == (pass == 0))
+                {
+                    positions.push_back(static_cast<std::uint32_t>(i));
+                }
+            }
+        }
+        bench::do_not_optimize(positions.data());
+    });
+
+    runner.run(prefix + "partition/variant_vector", [&vector] {
+        util::tag_permutation const positions = util::stable_partition_alternative<std::string>(vector);
+        bench::do_not_optimize(positions.data());
+    });
+}
+
+void report_sizes()
+{
+    std::vector<variant_type> const values = make_values(1000, false);
+    vector_type vector;
+    for (variant_type const& v : values)
+    {
+        vector.push_back(v);
+    }
+    std::size_t const vector_bytes = vector.tags().size() * sizeof(vector_type::tag_type) +
+                                     vector.offsets().size() * sizeof(vector_type::offset_type) +
+                                     vector.column<0>().size() * sizeof(std::int32_t) +
+                                     vector.column<1>().size() * sizeof(double) +
+                                     vector.column<2>().size() * sizeof(std::string);
+    std::cout << "bytes per value: std::vector<variant> " << sizeof(variant_type)
+              << ", variant_vector " << static_cast<double>(vector_bytes) / static_cast<double>(values.size())
+              << " (not counting spare capacity)" << std::endl;
+}
+
+} // namespace test
+
+int main(int argc, char** argv)
+{
+    bench::options opts;
+    if (!opts.parse(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+    bench::runner runner(opts);
+
+    test::report_sizes();
+    test::run(runner, false);
+    test::run(runner, true);
+    test::run_tags(runner);
+
+    return runner.finish();
+}
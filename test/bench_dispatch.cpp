@@ -0,0 +1,232 @@
+// Measures the cost of dispatching on the type of a variant, sweeping the
+// number of alternatives, the position of the most common alternative and
+// how predictable the sequence of types is.
+//
+// Built three times by the Makefile: with the default dispatch, with
+// MAPBOX_VARIANT_DISPATCH_TABLE_THRESHOLD=0 (always jump) and with
+// MAPBOX_VARIANT_DISPATCH_TABLE_THRESHOLD=64 (always the chain of type
+// checks). DISPATCH_LABEL names the build in the results.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+#include <mapbox/variant.hpp>
+
+#ifndef DISPATCH_LABEL
+#define DISPATCH_LABEL "default"
+#endif
+
+using namespace mapbox;
+
+namespace test {
+
+template <std::size_t I>
+struct alt
+{
+    std::uint32_t value;
+};
+
+template <std::size_t... Is>
+struct index_sequence
+{
+    using type = index_sequence;
+};
+
+template <std::size_t N, std::size_t... Is>
+struct make_index_sequence : make_index_sequence<N - 1, N - 1, Is...>
+{
+};
+
+template <std::size_t... Is>
+struct make_index_sequence<0, Is...> : index_sequence<Is...>
+{
+};
+
+template <typename Seq>
+struct variant_of;
+
+template <std::size_t... Is>
+struct variant_of<index_sequence<Is...>>
+{
+    using type = util::variant<alt<Is>...>;
+
+    template <std::size_t I>
+    static type make(std::uint32_t value)
+    {
+        return type(alt<I>{value});
+    }
+
+    // Constructs the alternative with a runtime index.
+    static type make(std::size_t index, std::uint32_t value)
+    {
+        using factory = type (*)(std::uint32_t);
+        static factory const factories[] = {&make<Is>...};
+        return factories[index](value);
+    }
+};
+
+// Each alternative gets different code, so that the compiler cannot merge
+// all cases into one.
+struct unary
+{
+    template <std::size_t I>
+    std::uint32_t operator()(alt<I> const& a) const
+    {
+        return a.value * static_cast<std::uint32_t>(I + 1);
+    }
+};
+
+struct binary
+{
+    template <std::size_t I, std::size_t J>
+    std::uint32_t operator()(alt<I> const& a, alt<J> const& b) const
+    {
+        return a.value * static_cast<std::uint32_t>(I + 1) + b.value * static_cast<std::uint32_t>(J + 1);
+    }
+};
+
+enum class distribution
+{
+    constant,    // always the hot alternative
+    skewed,      // the hot alternative 90% of the time, any other otherwise
+    round_robin, // each alternative in turn
+    random       // uniformly random
+};
+
+inline char const* name(distribution d)
+{
+    switch (d)
+    {
+    case distribution::constant: return "constant";
+    case distribution::skewed: return "skewed";
+    case distribution::round_robin: return "round_robin";
+    default: return "random";
+    }
+}
+
+template <std::size_t N>
+std::vector<std::size_t> make_indexes(std::size_t count, std::size_t hot, distribution d)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<std::size_t> any(0, N - 1);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<std::size_t> indexes;
+    indexes.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        switch (d)
+        {
+        case distribution::constant: indexes.push_back(hot); break;
+        case distribution::skewed: indexes.push_back(percent(gen) < 90 ? hot : any(gen)); break;
+        case distribution::round_robin: indexes.push_back(i % N); break;
+        default: indexes.push_back(any(gen)); break;
+        }
+    }
+    return indexes;
+}
+
+template <std::size_t N, std::size_t Hot>
+void run(bench::runner& runner, char const* position, distribution d)
+{
+    using maker = variant_of<typename make_index_sequence<N>::type>;
+    using variant_type = typename maker::type;
+    using hot_type = alt<Hot>;
+
+    std::size_t const count = runner.config().iterations;
+    std::vector<variant_type> values;
+    values.reserve(count + 1);
+    for (std::size_t index : make_indexes<N>(count + 1, Hot, d))
+    {
+        values.push_back(maker::make(index, static_cast<std::uint32_t>(values.size())));
+    }
+
+    std::ostringstream prefix;
+    prefix << DISPATCH_LABEL << "/N=" << std::setw(2) << std::setfill('0') << N << "/hot=" << position << "/" << name(d) << "/";
+
+    runner.run(prefix.str() + "apply_visitor", [&values, count] {
+        std::uint32_t total = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            total += util::apply_visitor(unary(), values[i]);
+        }
+        bench::do_not_optimize(total);
+    });
+
+    runner.run(prefix.str() + "match", [&values, count] {
+        std::uint32_t total = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            total += values[i].match(unary());
+        }
+        bench::do_not_optimize(total);
+    });
+
+    runner.run(prefix.str() + "binary", [&values, count] {
+        std::uint32_t total = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            total += util::apply_visitor(binary(), values[i], values[i + 1]);
+        }
+        bench::do_not_optimize(total);
+    });
+
+    runner.run(prefix.str() + "checked_get", [&values, count] {
+        std::uint32_t total = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (values[i].template is<hot_type>())
+            {
+                total += values[i].template get<hot_type>().value;
+            }
+        }
+        bench::do_not_optimize(total);
+    });
+}
+
+// The hot position only matters when one alternative dominates.
+template <std::size_t N>
+void sweep(bench::runner& runner)
+{
+    for (distribution d : {distribution::constant, distribution::skewed})
+    {
+        run<N, 0>(runner, "first", d);
+        run<N, N / 2>(runner, "middle", d);
+        run<N, N - 1>(runner, "last", d);
+    }
+    run<N, 0>(runner, "-", distribution::round_robin);
+    run<N, 0>(runner, "-", distribution::random);
+}
+
+} // namespace test
+
+int main(int argc, char** argv)
+{
+    bench::options opts;
+    if (!opts.parse(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+    bench::runner runner(opts);
+
+    test::sweep<2>(runner);
+    test::sweep<4>(runner);
+    // Sizes where the chain and the table are close.
+    test::sweep<6>(runner);
+    test::sweep<7>(runner);
+    test::sweep<8>(runner);
+    test::sweep<16>(runner);
+    test::sweep<32>(runner);
+    test::sweep<64>(runner);
+
+    return runner.finish();
+}
@@ -0,0 +1,160 @@
+// Compares the numeric column kernels with loops calling apply_visitor on
+// each value of a std::vector of variants, for columns where the type of
+// the values changes every few values and where it changes rarely.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+#include <mapbox/numeric_kernels.hpp>
+#include <mapbox/variant.hpp>
+
+using namespace mapbox;
+
+namespace test {
+
+using util::numeric_column;
+using util::numeric_value;
+
+// Mostly int64s and doubles, in runs of about mean_run values of one type.
+std::vector<numeric_value> make_values(std::size_t count, std::size_t mean_run, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::geometric_distribution<std::size_t> run(1.0 / static_cast<double>(mean_run));
+    std::uniform_int_distribution<std::int64_t> number(0, 1000000);
+    std::vector<numeric_value> values;
+    values.reserve(count);
+    while (values.size() < count)
+    {
+        int const type = percent(gen);
+        for (std::size_t n = run(gen) + 1; n > 0 && values.size() < count; --n)
+        {
+            std::int64_t const x = number(gen);
+            if (type < 50)
+            {
+                values.emplace_back(x);
+            }
+            else if (type < 90)
+            {
+                values.emplace_back(static_cast<double>(x) * 0.25);
+            }
+            else if (type < 95)
+            {
+                values.emplace_back(static_cast<std::uint64_t>(x));
+            }
+            else
+            {
+                values.emplace_back(x % 2 == 0);
+            }
+        }
+    }
+    return values;
+}
+
+numeric_column to_column(std::vector<numeric_value> const& values)
+{
+    numeric_column column;
+    column.reserve(values.size());
+    for (numeric_value const& v : values)
+    {
+        column.push_back(v);
+    }
+    return column;
+}
+
+void run(bench::runner& runner, std::size_t mean_run)
+{
+    std::size_t const count = runner.config().iterations;
+    std::vector<numeric_value> const lhs = make_values(count, mean_run, 1);
+    std::vector<numeric_value> const rhs = make_values(count, mean_run, 2);
+    numeric_column const a = to_column(lhs);
+    numeric_column const b = to_column(rhs);
+
+    std::string const prefix = "runs of " + std::to_string(mean_run) + "/";
+
+    runner.run(prefix + "sum/apply_visitor", [&lhs] {
+        numeric_value total{std::int64_t(0)};
+        for (numeric_value const& v : lhs)
+        {
+            total = util::apply_visitor(util::numeric_plus(), total, v);
+        }
+        bench::do_not_optimize(total);
+    });
+
+    runner.run(prefix + "sum/column_sum", [&a] {
+        bench::do_not_optimize(util::column_sum(a));
+    });
+
+    runner.run(prefix + "min/apply_visitor", [&lhs] {
+        numeric_value least = lhs.front();
+        for (numeric_value const& v : lhs)
+        {
+            if (util::apply_visitor(util::numeric_less(), v, least))
+            {
+                least = v;
+            }
+        }
+        bench::do_not_optimize(least);
+    });
+
+    runner.run(prefix + "min/column_min", [&a] {
+        bench::do_not_optimize(util::column_min(a));
+    });
+
+    // Both element wise loops write into results kept between samples, so
+    // that they measure the arithmetic rather than fresh allocations.
+    std::vector<numeric_value> visited_sums;
+    visited_sums.reserve(count);
+    runner.run(prefix + "add/apply_visitor", [&lhs, &rhs, &visited_sums] {
+        visited_sums.clear();
+        for (std::size_t i = 0; i < lhs.size(); ++i)
+        {
+            visited_sums.push_back(util::apply_visitor(util::numeric_plus(), lhs[i], rhs[i]));
+        }
+        bench::do_not_optimize(visited_sums.data());
+    });
+
+    numeric_column column_sums;
+    runner.run(prefix + "add/column_add", [&a, &b, &column_sums] {
+        util::column_add(a, b, column_sums);
+        bench::do_not_optimize(column_sums.tags().data());
+    });
+
+    util::tag_bitmask less;
+    runner.run(prefix + "less/apply_visitor", [&lhs, &rhs, &less] {
+        less.assign((lhs.size() + 63) / 64, 0);
+        for (std::size_t i = 0; i < lhs.size(); ++i)
+        {
+            less[i / 64] |= static_cast<std::uint64_t>(util::apply_visitor(util::numeric_less(), lhs[i], rhs[i])) << (i % 64);
+        }
+        bench::do_not_optimize(less.data());
+    });
+
+    runner.run(prefix + "less/column_less", [&a, &b, &less] {
+        util::column_less(a, b, less);
+        bench::do_not_optimize(less.data());
+    });
+}
+
+} // namespace test
+
+int main(int argc, char** argv)
+{
+    bench::options opts;
+    if (!opts.parse(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+    bench::runner runner(opts);
+
+    test::run(runner, 4);
+    test::run(runner, 1000);
+
+    return runner.finish();
+}
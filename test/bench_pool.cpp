@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "auto_cpu_timer.hpp"
+
+#include <mapbox/pool_allocator.hpp>
+#include <mapbox/variant.hpp>
+
+using namespace mapbox;
+
+namespace test {
+
+struct add;
+struct sub;
+
+template <typename OpTag, template <typename> class Wrapper>
+struct binary_op;
+
+template <template <typename> class Wrapper>
+using expression = util::variant<int,
+                                 Wrapper<binary_op<add, Wrapper>>,
+                                 Wrapper<binary_op<sub, Wrapper>>>;
+
+template <typename Op, template <typename> class Wrapper>
+struct binary_op
+{
+    expression<Wrapper> left;
+    expression<Wrapper> right;
+
+    binary_op(expression<Wrapper>&& lhs, expression<Wrapper>&& rhs)
+        : left(std::move(lhs)), right(std::move(rhs))
+    {
+    }
+};
+
+template <template <typename> class Wrapper>
+struct calculator
+{
+    int operator()(int value) const
+    {
+        return value;
+    }
+
+    int operator()(binary_op<add, Wrapper> const& binary) const
+    {
+        return util::apply_visitor(*this, binary.left) + util::apply_visitor(*this, binary.right);
+    }
+
+    int operator()(binary_op<sub, Wrapper> const& binary) const
+    {
+        return util::apply_visitor(*this, binary.left) - util::apply_visitor(*this, binary.right);
+    }
+};
+
+template <template <typename> class Wrapper>
+expression<Wrapper> make_tree(int depth)
+{
+    if (depth == 0)
+    {
+        return expression<Wrapper>(1);
+    }
+    return depth % 2 == 0
+        ? expression<Wrapper>(binary_op<add, Wrapper>(make_tree<Wrapper>(depth - 1), make_tree<Wrapper>(depth - 1)))
+        : expression<Wrapper>(binary_op<sub, Wrapper>(make_tree<Wrapper>(depth - 1), make_tree<Wrapper>(depth - 1)));
+}
+
+// Replaces subtrees of a long-lived tree over and over, like an editor or a
+// style rule engine would.
+template <template <typename> class Wrapper>
+int churn(std::size_t num_iter)
+{
+    int total = 0;
+    std::vector<expression<Wrapper>> trees(64);
+    for (std::size_t i = 0; i < num_iter; ++i)
+    {
+        auto& tree = trees[i % trees.size()];
+        tree = make_tree<Wrapper>(static_cast<int>(i % 6));
+        total += util::apply_visitor(calculator<Wrapper>(), tree);
+    }
+    return total;
+}
+
+// Builds trees on one thread and destroys them on another, so that freed
+// nodes pile up on the consumer and go back through the global list.
+template <template <typename> class Wrapper>
+class handoff
+{
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::vector<expression<Wrapper>>> batches_;
+    std::size_t producers_left_;
+
+public:
+    explicit handoff(std::size_t producers)
+        : producers_left_(producers) {}
+
+    void produce(std::size_t num_iter)
+    {
+        std::vector<expression<Wrapper>> batch;
+        for (std::size_t i = 0; i < num_iter; ++i)
+        {
+            batch.push_back(make_tree<Wrapper>(static_cast<int>(i % 6)));
+            if (batch.size() == 64)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                batches_.push_back(std::move(batch));
+                batch.clear();
+                cv_.notify_one();
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        --producers_left_;
+        cv_.notify_all();
+    }
+
+    int consume()
+    {
+        int total = 0;
+        for (;;)
+        {
+            std::vector<expression<Wrapper>> batch;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return !batches_.empty() || producers_left_ == 0; });
+                if (batches_.empty())
+                {
+                    return total;
+                }
+                batch = std::move(batches_.front());
+                batches_.pop_front();
+            }
+            for (auto const& tree : batch)
+            {
+                total += util::apply_visitor(calculator<Wrapper>(), tree);
+            }
+        }
+    }
+};
+
+template <template <typename> class Wrapper>
+void run(char const* name, std::size_t num_threads, std::size_t num_iter)
+{
+    std::vector<std::thread> threads;
+    std::vector<int> results(num_threads);
+    {
+        std::cerr << name << " churn with " << num_threads << " threads: ";
+        auto_cpu_timer t;
+        for (std::size_t i = 0; i < num_threads; ++i)
+        {
+            threads.emplace_back([&results, i, num_iter] { results[i] = churn<Wrapper>(num_iter); });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+    threads.clear();
+    {
+        std::cerr << name << " handoff with " << num_threads << " producers and consumers: ";
+        auto_cpu_timer t;
+        handoff<Wrapper> queue(num_threads);
+        for (std::size_t i = 0; i < num_threads; ++i)
+        {
+            threads.emplace_back([&queue, num_iter] { queue.produce(num_iter); });
+            threads.emplace_back([&queue, &results, i] { results[i] = queue.consume(); });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+}
+
+} // namespace test
+
+template <typename T>
+using default_wrapper = util::recursive_wrapper<T>;
+
+template <typename T>
+using pooled_wrapper = util::pooled_recursive_wrapper<T>;
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage" << argv[0] << " <num-iter>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::size_t NUM_ITER = static_cast<std::size_t>(std::stol(argv[1])) * 10;
+    const std::size_t max_threads = std::max(2u, std::thread::hardware_concurrency());
+
+    for (std::size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2)
+    {
+        test::run<default_wrapper>("new T", num_threads, NUM_ITER);
+        test::run<pooled_wrapper>("pool ", num_threads, NUM_ITER);
+    }
+
+    util::pool_stats const stats = util::pool_allocator<test::binary_op<test::add, pooled_wrapper>>::stats();
+    std::cerr << "pool of binary_op<add>: "
+              << stats.allocations << " allocations, "
+              << stats.system_allocations << " from the system, "
+              << stats.refills << " refills, "
+              << stats.spills << " spills" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include <mapbox/reclaimer.hpp>
+#include <mapbox/variant.hpp>
+
+using namespace mapbox;
+
+namespace test {
+
+struct add;
+
+using document = util::variant<int, util::recursive_wrapper<add>>;
+
+struct add
+{
+    document left;
+    document right;
+};
+
+document make_document(int depth)
+{
+    if (depth == 0)
+    {
+        return document(1);
+    }
+    return document(add{make_document(depth - 1), make_document(depth - 1)});
+}
+
+int evaluate(document const& d, int depth)
+{
+    if (d.is<int>())
+    {
+        return d.get_unchecked<int>();
+    }
+    if (depth == 0)
+    {
+        return 1;
+    }
+    add const& a = d.get<add>();
+    return evaluate(a.left, depth - 1) + evaluate(a.right, depth - 1);
+}
+
+using steady_clock = std::chrono::steady_clock;
+
+struct latencies
+{
+    std::vector<double> reads;
+    std::vector<double> replacements;
+};
+
+// Serves small requests reading the document, and every 100th request one
+// that replaces the whole document, and records how long each took.
+template <typename Replace>
+latencies serve(std::size_t num_replacements, int depth, Replace replace)
+{
+    latencies result;
+    document doc = make_document(depth);
+    int total = 0;
+    for (std::size_t i = 0; i < num_replacements; ++i)
+    {
+        document next = make_document(depth);
+        for (int j = 0; j < 99; ++j)
+        {
+            steady_clock::time_point const start = steady_clock::now();
+            total += evaluate(doc, 8);
+            result.reads.push_back(std::chrono::duration<double, std::micro>(steady_clock::now() - start).count());
+        }
+        steady_clock::time_point const start = steady_clock::now();
+        replace(doc, next);
+        result.replacements.push_back(std::chrono::duration<double, std::micro>(steady_clock::now() - start).count());
+    }
+    if (total == 0)
+    {
+        std::cerr << "unexpected total" << std::endl;
+    }
+    return result;
+}
+
+void report(char const* name, std::vector<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        return samples[static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1))];
+    };
+    std::cerr << name << ": p50 " << percentile(0.5) << "us, p99 " << percentile(0.99)
+              << "us, max " << samples.back() << "us" << std::endl;
+}
+
+void report(char const* name, latencies const& l)
+{
+    std::vector<double> all(l.reads);
+    all.insert(all.end(), l.replacements.begin(), l.replacements.end());
+    std::cerr << name << std::endl;
+    report("  replacements", l.replacements);
+    report("  all requests", all);
+}
+
+} // namespace test
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage" << argv[0] << " <num-iter>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::size_t NUM_REPLACEMENTS = static_cast<std::size_t>(std::stol(argv[1])) / 5000 + 1;
+    const int DEPTH = 20; // a document of about a million nodes
+
+    test::report("replace inline", test::serve(NUM_REPLACEMENTS, DEPTH, [](test::document& doc, test::document& next) {
+                     test::document old = std::move(doc);
+                     doc = std::move(next);
+                 }));
+
+    util::reclaimer reclaimer;
+    test::report("replace with reclaimer", test::serve(NUM_REPLACEMENTS, DEPTH, [&reclaimer](test::document& doc, test::document& next) {
+                     reclaimer.retire(std::move(doc));
+                     doc = std::move(next);
+                 }));
+    reclaimer.flush();
+
+    util::reclaimer_stats const stats = reclaimer.stats();
+    std::cerr << "reclaimer: " << stats.reclaimed << " documents in " << stats.batches << " batches" << std::endl;
+
+    return EXIT_SUCCESS;
+}
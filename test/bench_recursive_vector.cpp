@@ -0,0 +1,138 @@
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "auto_cpu_timer.hpp"
+
+#include <mapbox/variant.hpp>
+
+using namespace mapbox;
+
+namespace test {
+
+struct add;
+struct sub;
+
+template <typename OpTag>
+struct binary_op;
+
+using expression = util::variant<int,
+                                 util::recursive_wrapper<binary_op<add>>,
+                                 util::recursive_wrapper<binary_op<sub>>>;
+
+template <typename Op>
+struct binary_op
+{
+    expression left;
+    expression right;
+
+    binary_op(expression&& lhs, expression&& rhs)
+        : left(std::move(lhs)), right(std::move(rhs))
+    {
+    }
+};
+
+struct calculator
+{
+    int operator()(int value) const
+    {
+        return value;
+    }
+
+    int operator()(binary_op<add> const& binary) const
+    {
+        return util::apply_visitor(*this, binary.left) + util::apply_visitor(*this, binary.right);
+    }
+
+    int operator()(binary_op<sub> const& binary) const
+    {
+        return util::apply_visitor(*this, binary.left) - util::apply_visitor(*this, binary.right);
+    }
+};
+
+expression make_tree(int depth)
+{
+    if (depth == 0)
+    {
+        return expression(1);
+    }
+    return depth % 2 == 0
+        ? expression(binary_op<add>(make_tree(depth - 1), make_tree(depth - 1)))
+        : expression(binary_op<sub>(make_tree(depth - 1), make_tree(depth - 1)));
+}
+
+// Same as expression, but its move constructor may throw, so a growing
+// std::vector copies the trees instead of moving them.
+struct copied_on_growth
+{
+    expression value;
+
+    explicit copied_on_growth(expression&& v)
+        : value(std::move(v)) {}
+
+    copied_on_growth(copied_on_growth const&) = default;
+
+    copied_on_growth(copied_on_growth&& other) noexcept(false)
+        : value(std::move(other.value)) {}
+};
+
+int evaluate(expression const& e)
+{
+    return util::apply_visitor(calculator(), e);
+}
+
+int evaluate(copied_on_growth const& e)
+{
+    return evaluate(e.value);
+}
+
+template <typename T>
+int grow(std::size_t num_trees, int depth)
+{
+    std::vector<T> trees;
+    for (std::size_t i = 0; i < num_trees; ++i)
+    {
+        trees.emplace_back(make_tree(depth));
+    }
+    int total = 0;
+    for (auto const& tree : trees)
+    {
+        total += evaluate(tree);
+    }
+    return total;
+}
+
+} // namespace test
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage" << argv[0] << " <num-iter>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::size_t NUM_TREES = static_cast<std::size_t>(std::stol(argv[1]));
+    const int DEPTH = 6;
+
+    int result_move = 0;
+    int result_copy = 0;
+    {
+        std::cerr << "vector<expression> (moves on growth): ";
+        auto_cpu_timer t;
+        result_move = test::grow<test::expression>(NUM_TREES, DEPTH);
+    }
+    {
+        std::cerr << "vector<copied_on_growth> (copies on growth): ";
+        auto_cpu_timer t;
+        result_copy = test::grow<test::copied_on_growth>(NUM_TREES, DEPTH);
+    }
+    if (result_move != result_copy)
+    {
+        std::cerr << "mismatch " << result_move << " != " << result_copy << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
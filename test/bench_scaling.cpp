@@ -0,0 +1,402 @@
+// Measures how construction, visitation, copying and destruction of
+// variants scale with the number of threads. Each thread works on its own
+// values, so any loss of throughput comes from shared resources, mostly the
+// allocator that the string and recursive_wrapper alternatives use.
+//
+// --allocator=system uses std::allocator, --allocator=arena a bump
+// allocator with one arena per thread, which never synchronizes.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+
+#include <mapbox/variant.hpp>
+
+using namespace mapbox;
+
+namespace test {
+
+#define TEXT_LONG "Testing various variant implementations with a longish string ........................................."
+
+// Hands out memory from fixed-size chunks. Deallocation is a no-op; reset()
+// makes all memory available again.
+class arena
+{
+    static constexpr std::size_t chunk_size = 1 << 20;
+
+public:
+    arena() = default;
+    arena(arena const&) = delete;
+    arena& operator=(arena const&) = delete;
+
+    ~arena()
+    {
+        reset();
+        for (char* chunk : chunks_)
+        {
+            ::operator delete(chunk);
+        }
+    }
+
+    void* allocate(std::size_t bytes, std::size_t alignment)
+    {
+        if (bytes + alignment > chunk_size)
+        {
+            large_.push_back(static_cast<char*>(::operator new(bytes)));
+            return large_.back();
+        }
+        std::size_t offset = (used_ + alignment - 1) & ~(alignment - 1);
+        if (current_ == chunks_.size() || offset + bytes > chunk_size)
+        {
+            if (current_ < chunks_.size())
+            {
+                ++current_;
+            }
+            if (current_ == chunks_.size())
+            {
+                chunks_.push_back(static_cast<char*>(::operator new(chunk_size)));
+            }
+            offset = 0;
+        }
+        used_ = offset + bytes;
+        return chunks_[current_] + offset;
+    }
+
+    void reset()
+    {
+        for (char* block : large_)
+        {
+            ::operator delete(block);
+        }
+        large_.clear();
+        current_ = 0;
+        used_ = 0;
+    }
+
+private:
+    std::vector<char*> chunks_;
+    std::vector<char*> large_;
+    std::size_t current_ = 0;
+    std::size_t used_ = 0;
+};
+
+inline arena& local_arena()
+{
+    static thread_local arena a;
+    return a;
+}
+
+// Allocates from the arena of the calling thread, so memory must be
+// released on the thread that allocated it.
+template <typename T>
+struct arena_allocator
+{
+    using value_type = T;
+
+    arena_allocator() = default;
+
+    template <typename U>
+    arena_allocator(arena_allocator<U> const&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(local_arena().allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, std::size_t) noexcept {}
+};
+
+template <typename T, typename U>
+bool operator==(arena_allocator<T> const&, arena_allocator<U> const&) { return true; }
+
+template <typename T, typename U>
+bool operator!=(arena_allocator<T> const&, arena_allocator<U> const&) { return false; }
+
+struct system_allocation
+{
+    static constexpr char const* name = "system";
+
+    template <typename T>
+    using allocator = std::allocator<T>;
+
+    static void reset() {}
+};
+
+struct arena_allocation
+{
+    static constexpr char const* name = "arena";
+
+    template <typename T>
+    using allocator = arena_allocator<T>;
+
+    static void reset() { local_arena().reset(); }
+};
+
+template <typename Allocation>
+struct payload
+{
+    using string = std::basic_string<char, std::char_traits<char>, typename Allocation::template allocator<char>>;
+
+    struct point
+    {
+        std::int64_t x;
+        std::int64_t y;
+    };
+
+    using variant = util::variant<int, double, string,
+                                  util::recursive_wrapper<point, typename Allocation::template allocator<point>>>;
+    using vector = std::vector<variant, typename Allocation::template allocator<variant>>;
+
+    struct measure
+    {
+        std::size_t operator()(int value) const { return static_cast<std::size_t>(value); }
+        std::size_t operator()(double value) const { return static_cast<std::size_t>(value); }
+        std::size_t operator()(string const& value) const { return value.size(); }
+        std::size_t operator()(point const& value) const { return static_cast<std::size_t>(value.x + value.y); }
+    };
+
+    static void fill(vector& values, std::size_t count)
+    {
+        values.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            switch (i % 4)
+            {
+            case 0: values.emplace_back(static_cast<int>(i)); break;
+            case 1: values.emplace_back(static_cast<double>(i)); break;
+            case 2: values.emplace_back(string(TEXT_LONG)); break;
+            default: values.emplace_back(point{1, 2}); break;
+            }
+        }
+    }
+};
+
+enum phase
+{
+    construct,
+    visit,
+    copy,
+    destroy,
+    num_phases
+};
+
+char const* const phase_names[num_phases] = {"construct", "visit", "copy", "destroy"};
+
+// Releases all threads once the last one has arrived.
+class barrier
+{
+public:
+    explicit barrier(std::size_t count)
+        : count_(count) {}
+
+    void arrive_and_wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        std::size_t const generation = generation_;
+        if (++arrived_ == count_)
+        {
+            arrived_ = 0;
+            ++generation_;
+            condition_.notify_all();
+            return;
+        }
+        condition_.wait(lock, [this, generation] { return generation != generation_; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::size_t const count_;
+    std::size_t arrived_ = 0;
+    std::size_t generation_ = 0;
+};
+
+using steady_clock = std::chrono::steady_clock;
+
+// Runs each phase on all threads at once and returns, per phase, the time
+// from the start of the phase until the slowest thread finished it.
+template <typename Allocation>
+std::vector<double> run_round(std::size_t num_threads, std::size_t count)
+{
+    using types = payload<Allocation>;
+
+    barrier sync(num_threads);
+    std::vector<std::vector<double>> durations(num_threads, std::vector<double>(num_phases));
+    auto work = [&sync, &durations, count](std::size_t thread) {
+        std::vector<double>& d = durations[thread];
+        steady_clock::time_point start;
+        auto begin = [&sync, &start] {
+            sync.arrive_and_wait();
+            start = steady_clock::now();
+        };
+        auto end = [&d, &start](phase p) {
+            d[p] = std::chrono::duration<double>(steady_clock::now() - start).count();
+        };
+        {
+            typename types::vector values;
+            begin();
+            types::fill(values, count);
+            end(construct);
+
+            begin();
+            std::size_t total = 0;
+            for (auto const& v : values)
+            {
+                total += util::apply_visitor(typename types::measure(), v);
+            }
+            bench::do_not_optimize(total);
+            end(visit);
+
+            begin();
+            typename types::vector copies(values);
+            bench::do_not_optimize(copies);
+            end(copy);
+
+            begin();
+            values = typename types::vector();
+            copies = typename types::vector();
+            end(destroy);
+        }
+        Allocation::reset();
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < num_threads; ++i)
+    {
+        threads.emplace_back(work, i);
+    }
+    work(0);
+    for (std::thread& t : threads)
+    {
+        t.join();
+    }
+
+    std::vector<double> slowest(num_phases, 0);
+    for (std::vector<double> const& d : durations)
+    {
+        for (std::size_t p = 0; p < num_phases; ++p)
+        {
+            slowest[p] = std::max(slowest[p], d[p]);
+        }
+    }
+    return slowest;
+}
+
+// Reports the throughput of each phase for 1 to max_threads threads, and
+// its efficiency: the throughput relative to that of one thread times the
+// number of threads.
+template <typename Allocation>
+void run(std::vector<std::size_t> const& thread_counts, std::size_t count, std::size_t rounds)
+{
+    std::vector<double> single(num_phases, 0);
+    for (std::size_t num_threads : thread_counts)
+    {
+        std::vector<std::vector<double>> samples(num_phases);
+        for (std::size_t r = 0; r < rounds; ++r)
+        {
+            std::vector<double> const slowest = run_round<Allocation>(num_threads, count);
+            for (std::size_t p = 0; p < num_phases; ++p)
+            {
+                samples[p].push_back(slowest[p]);
+            }
+        }
+        for (std::size_t p = 0; p < num_phases; ++p)
+        {
+            std::sort(samples[p].begin(), samples[p].end());
+            double const seconds = samples[p][samples[p].size() / 2];
+            double const throughput = static_cast<double>(num_threads * count) / seconds;
+            if (num_threads == 1)
+            {
+                single[p] = throughput;
+            }
+            std::ostringstream line;
+            line << std::left << std::setw(10) << Allocation::name << std::right << std::setw(7) << num_threads
+                 << "  " << std::left << std::setw(10) << phase_names[p] << std::right << std::fixed
+                 << std::setprecision(2) << std::setw(10) << throughput / 1e6 << " Mops/s";
+            if (single[p] > 0)
+            {
+                line << std::setprecision(0) << std::setw(11)
+                     << 100 * throughput / (single[p] * static_cast<double>(num_threads)) << "%";
+            }
+            std::cerr << line.str() << std::endl;
+        }
+    }
+}
+
+} // namespace test
+
+int main(int argc, char** argv)
+{
+    std::size_t count = 0;
+    std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t rounds = 5;
+    std::string allocator = "both";
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const arg = argv[i];
+        if (arg.compare(0, 10, "--threads=") == 0)
+        {
+            max_threads = static_cast<std::size_t>(std::stoul(arg.substr(10)));
+        }
+        else if (arg.compare(0, 9, "--rounds=") == 0)
+        {
+            rounds = static_cast<std::size_t>(std::stoul(arg.substr(9)));
+        }
+        else if (arg.compare(0, 12, "--allocator=") == 0)
+        {
+            allocator = arg.substr(12);
+        }
+        else if (arg.compare(0, 2, "--") != 0)
+        {
+            count = static_cast<std::size_t>(std::stoul(arg));
+        }
+        else
+        {
+            count = 0;
+            break;
+        }
+    }
+    if (count == 0 || max_threads == 0 || rounds == 0 ||
+        (allocator != "both" && allocator != "system" && allocator != "arena"))
+    {
+        std::cerr << "Usage: " << argv[0] << " <values-per-thread> [--threads=N] [--rounds=N]"
+                  << " [--allocator=system|arena|both]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Doubling up to max_threads, and max_threads itself.
+    std::vector<std::size_t> thread_counts;
+    for (std::size_t n = 1; n < max_threads; n *= 2)
+    {
+        thread_counts.push_back(n);
+    }
+    thread_counts.push_back(max_threads);
+
+    std::cerr << std::left << std::setw(10) << "allocator" << std::right << std::setw(7) << "threads" << "  "
+              << std::left << std::setw(10) << "phase" << std::right << std::setw(17) << "throughput"
+              << std::setw(12) << "efficiency" << std::endl;
+    if (allocator != "arena")
+    {
+        test::run<test::system_allocation>(thread_counts, count, rounds);
+    }
+    if (allocator != "system")
+    {
+        test::run<test::arena_allocation>(thread_counts, count, rounds);
+    }
+
+    return EXIT_SUCCESS;
+}
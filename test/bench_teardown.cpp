@@ -0,0 +1,147 @@
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "auto_cpu_timer.hpp"
+
+#include <mapbox/variant.hpp>
+
+using namespace mapbox;
+
+namespace test {
+
+// std::allocator with a state, so that wrappers using it destroy their
+// trees recursively, as all wrappers used to.
+template <typename T>
+struct stateful_allocator : std::allocator<T>
+{
+    int state = 0;
+
+    stateful_allocator() = default;
+
+    template <typename U>
+    stateful_allocator(stateful_allocator<U> const& other) noexcept
+        : state(other.state) {}
+
+    template <typename U>
+    struct rebind
+    {
+        using other = stateful_allocator<U>;
+    };
+};
+
+template <typename T, typename U>
+bool operator==(stateful_allocator<T> const& lhs, stateful_allocator<U> const& rhs)
+{
+    return lhs.state == rhs.state;
+}
+
+template <typename T, typename U>
+bool operator!=(stateful_allocator<T> const& lhs, stateful_allocator<U> const& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <template <typename> class Alloc>
+struct node;
+
+template <template <typename> class Alloc>
+using tree = util::variant<int, util::recursive_wrapper<node<Alloc>, Alloc<node<Alloc>>>>;
+
+} // namespace test
+
+// Opts the trees into bounded destruction, which only wrappers with a
+// stateless allocator can use.
+namespace mapbox {
+namespace util {
+
+template <template <typename> class Alloc>
+struct bounded_teardown<test::node<Alloc>> : std::true_type
+{
+};
+
+} // namespace util
+} // namespace mapbox
+
+namespace test {
+
+template <template <typename> class Alloc>
+struct node
+{
+    tree<Alloc> left;
+    tree<Alloc> right;
+};
+
+template <template <typename> class Alloc>
+tree<Alloc> make_tree(int depth)
+{
+    if (depth == 0)
+    {
+        return tree<Alloc>(1);
+    }
+    return tree<Alloc>(node<Alloc>{make_tree<Alloc>(depth - 1), make_tree<Alloc>(depth - 1)});
+}
+
+template <template <typename> class Alloc>
+tree<Alloc> make_chain(std::size_t length)
+{
+    tree<Alloc> head(0);
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        head = node<Alloc>{std::move(head), tree<Alloc>(1)};
+    }
+    return head;
+}
+
+template <template <typename> class Alloc>
+void run(char const* name, std::size_t num_trees, int depth, std::size_t length)
+{
+    {
+        std::unique_ptr<tree<Alloc>[]> trees(new tree<Alloc>[num_trees]);
+        for (std::size_t i = 0; i < num_trees; ++i)
+        {
+            trees[i] = make_tree<Alloc>(depth);
+        }
+        std::cerr << name << " destroying " << num_trees << " trees of depth " << depth << ": ";
+        auto_cpu_timer t;
+        trees.reset();
+    }
+    {
+        std::unique_ptr<tree<Alloc>> chain(new tree<Alloc>(make_chain<Alloc>(length)));
+        std::cerr << name << " destroying a chain of " << length << " nodes: ";
+        auto_cpu_timer t;
+        chain.reset();
+    }
+}
+
+} // namespace test
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage" << argv[0] << " <num-iter>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::size_t NUM_ITER = static_cast<std::size_t>(std::stol(argv[1]));
+    const std::size_t NUM_TREES = NUM_ITER / 1000 > 0 ? NUM_ITER / 1000 : 1;
+    const int DEPTH = 12;
+    // short enough for the recursive destruction to fit on the stack
+    const std::size_t LENGTH = 10000;
+
+    test::run<test::stateful_allocator>("recursive", NUM_TREES, DEPTH, LENGTH);
+    test::run<std::allocator>("bounded  ", NUM_TREES, DEPTH, LENGTH);
+
+    {
+        using chain_type = test::tree<std::allocator>;
+        std::unique_ptr<chain_type> chain(new chain_type(test::make_chain<std::allocator>(NUM_ITER * 100)));
+        std::cerr << "bounded   destroying a chain of " << NUM_ITER * 100 << " nodes: ";
+        auto_cpu_timer t;
+        chain.reset();
+    }
+
+    return EXIT_SUCCESS;
+}
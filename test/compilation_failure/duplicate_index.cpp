@@ -0,0 +1,13 @@
+// @EXPECTED: Alternatives selected by index must not be duplicated
+
+#include <mapbox/variant.hpp>
+
+#include <string>
+
+// Checks that an alternative whose type occurs more than once can not be
+// selected by index, as the variant would look it up as the first one.
+
+int main()
+{
+    mapbox::util::variant<int, std::string, std::string> x{mapbox::util::in_place_index_t<2>{}, "two"};
+}
@@ -0,0 +1,438 @@
+#pragma once
+
+// Minimal benchmark harness with no dependencies: runs each benchmark a few
+// times to warm up, then times a number of samples and reports their
+// minimum, median, mean and standard deviation. Where the platform allows
+// it, hardware counters (see perf_counters.hpp) are read over the samples
+// and reported per operation next to the timings. Results can be written as
+// JSON, saved as a baseline, and compared against a saved baseline.
+//
+//   int main(int argc, char** argv)
+//   {
+//       bench::options opts;
+//       if (!opts.parse(argc, argv)) return EXIT_FAILURE;
+//       bench::runner runner(opts);
+//       runner.run("visit", [&] { ... opts.iterations operations ... });
+//       return runner.finish();
+//   }
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "perf_counters.hpp"
+
+namespace bench {
+
+// Keeps the compiler from optimizing away the computation of value.
+template <typename T>
+inline void do_not_optimize(T const& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile(""
+                 :
+                 : "r,m"(value)
+                 : "memory");
+#else
+    static volatile char const* sink;
+    sink = reinterpret_cast<char const volatile*>(&value);
+#endif
+}
+
+// Makes the compiler assume that all memory may have been read and written.
+inline void clobber_memory()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile(""
+                 :
+                 :
+                 : "memory");
+#endif
+}
+
+struct options
+{
+    std::size_t iterations = 0; // operations per sample, passed to the benchmarks
+    std::size_t warmup = 1;
+    std::size_t samples = 10;
+    std::string filter;        // only run benchmarks whose name contains this
+    std::string json;          // write results here, "-" for stdout
+    std::string save_baseline; // write results here for later comparison
+    std::string baseline;      // compare results against this file
+    double threshold = 0.05;   // relative slowdown reported as a regression
+    bool counters = true;      // read hardware counters when available
+
+    static void usage(char const* program)
+    {
+        std::cerr << "Usage: " << program << " <num-iter> [--samples=N] [--warmup=N] [--filter=TEXT]"
+                  << " [--json=FILE] [--save-baseline=FILE] [--baseline=FILE] [--threshold=FRACTION] [--no-counters]" << std::endl;
+    }
+
+    bool parse(int argc, char** argv)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string const arg = argv[i];
+            std::string value;
+            if (arg.compare(0, 2, "--") != 0)
+            {
+                iterations = static_cast<std::size_t>(std::stoul(arg));
+            }
+            else if (option(arg, "--samples=", value))
+            {
+                samples = static_cast<std::size_t>(std::stoul(value));
+            }
+            else if (option(arg, "--warmup=", value))
+            {
+                warmup = static_cast<std::size_t>(std::stoul(value));
+            }
+            else if (option(arg, "--filter=", filter) ||
+                     option(arg, "--json=", json) ||
+                     option(arg, "--save-baseline=", save_baseline) ||
+                     option(arg, "--baseline=", baseline))
+            {
+            }
+            else if (option(arg, "--threshold=", value))
+            {
+                threshold = std::stod(value);
+            }
+            else if (arg == "--no-counters")
+            {
+                counters = false;
+            }
+            else
+            {
+                usage(argv[0]);
+                return false;
+            }
+        }
+        if (iterations == 0 || samples == 0)
+        {
+            usage(argv[0]);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static bool option(std::string const& arg, char const* prefix, std::string& value)
+    {
+        std::string const p(prefix);
+        if (arg.compare(0, p.size(), p) != 0)
+        {
+            return false;
+        }
+        value = arg.substr(p.size());
+        return true;
+    }
+};
+
+struct result
+{
+    std::string name;
+    std::size_t iterations;
+    std::size_t samples;
+    double min_ns;
+    double median_ns;
+    double mean_ns;
+    double stddev_ns;
+    counter_values counters; // mean hardware event counts per iteration
+
+    double ns_per_iteration() const
+    {
+        return median_ns / static_cast<double>(iterations);
+    }
+
+    // Returns the count of the event per iteration, or -1 if it was not
+    // measured.
+    double counter(std::string const& event) const
+    {
+        for (auto const& c : counters)
+        {
+            if (c.first == event)
+            {
+                return c.second;
+            }
+        }
+        return -1;
+    }
+
+    // Instructions per cycle, or -1 if either was not measured.
+    double ipc() const
+    {
+        double const instructions = counter("instructions");
+        double const cycles = counter("cycles");
+        return instructions >= 0 && cycles > 0 ? instructions / cycles : -1;
+    }
+};
+
+inline result summarize(std::string const& name, std::size_t iterations, std::vector<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+    std::size_t const n = samples.size();
+    double sum = 0;
+    for (double s : samples)
+    {
+        sum += s;
+    }
+    double const mean = sum / static_cast<double>(n);
+    double squares = 0;
+    for (double s : samples)
+    {
+        squares += (s - mean) * (s - mean);
+    }
+    result r;
+    r.name = name;
+    r.iterations = iterations;
+    r.samples = n;
+    r.min_ns = samples.front();
+    r.median_ns = n % 2 == 1 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    r.mean_ns = mean;
+    r.stddev_ns = n > 1 ? std::sqrt(squares / static_cast<double>(n - 1)) : 0;
+    return r;
+}
+
+// Writes one benchmark per line, which read_baseline() relies on.
+inline void write_json(std::ostream& out, std::vector<result> const& results)
+{
+    out << "{\n  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        result const& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\""
+            << ", \"iterations\": " << r.iterations
+            << ", \"samples\": " << r.samples
+            << std::fixed << std::setprecision(1)
+            << ", \"min_ns\": " << r.min_ns
+            << ", \"median_ns\": " << r.median_ns
+            << ", \"mean_ns\": " << r.mean_ns
+            << ", \"stddev_ns\": " << r.stddev_ns
+            << std::setprecision(3)
+            << ", \"ns_per_iteration\": " << r.ns_per_iteration();
+        if (!r.counters.empty())
+        {
+            out << ", \"counters\": {";
+            for (std::size_t j = 0; j < r.counters.size(); ++j)
+            {
+                out << (j > 0 ? ", " : "") << "\"" << r.counters[j].first << "\": " << r.counters[j].second;
+            }
+            out << "}";
+            if (r.ipc() >= 0)
+            {
+                out << ", \"ipc\": " << r.ipc();
+            }
+        }
+        out << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+        out.unsetf(std::ios::floatfield);
+    }
+    out << "  ]\n}\n";
+}
+
+// Reads the median time per iteration of each benchmark from a file
+// written by write_json().
+inline std::map<std::string, double> read_baseline(std::string const& path)
+{
+    std::map<std::string, double> baseline;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::string const name_key = "\"name\": \"";
+        std::string const value_key = "\"ns_per_iteration\": ";
+        std::size_t const name_pos = line.find(name_key);
+        std::size_t const value_pos = line.find(value_key);
+        if (name_pos == std::string::npos || value_pos == std::string::npos)
+        {
+            continue;
+        }
+        std::size_t const name_begin = name_pos + name_key.size();
+        std::string const name = line.substr(name_begin, line.find('"', name_begin) - name_begin);
+        baseline[name] = std::stod(line.substr(value_pos + value_key.size()));
+    }
+    return baseline;
+}
+
+class runner
+{
+public:
+    explicit runner(options const& opts)
+        : options_(opts)
+    {
+        if (options_.counters)
+        {
+            counters_.reset(new perf_counters());
+            if (!counters_->available())
+            {
+                std::cerr << "hardware counters unavailable, reporting timings only" << std::endl;
+                counters_.reset();
+            }
+        }
+    }
+
+    options const& config() const { return options_; }
+
+    // Runs f, which performs options::iterations operations, warmup times
+    // and then samples times, timing each run. Hardware counters are summed
+    // over the samples, outside of the timed region.
+    template <typename F>
+    void run(std::string const& name, F&& f)
+    {
+        if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos)
+        {
+            return;
+        }
+        for (std::size_t i = 0; i < options_.warmup; ++i)
+        {
+            f();
+        }
+        std::vector<double> samples;
+        counter_values totals;
+        for (std::size_t i = 0; i < options_.samples; ++i)
+        {
+            if (counters_)
+            {
+                counters_->start();
+            }
+            auto const start = std::chrono::steady_clock::now();
+            f();
+            clobber_memory();
+            auto const end = std::chrono::steady_clock::now();
+            if (counters_)
+            {
+                counters_->stop();
+                accumulate(totals, counters_->read());
+            }
+            samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+        }
+        results_.push_back(summarize(name, options_.iterations, std::move(samples)));
+        double const operations = static_cast<double>(options_.iterations * options_.samples);
+        for (auto& total : totals)
+        {
+            total.second /= operations;
+        }
+        results_.back().counters = std::move(totals);
+        report(results_.back());
+    }
+
+    std::vector<result> const& results() const { return results_; }
+
+    // Writes the results and compares them against the baseline. Returns
+    // the exit status of the program: failure if any benchmark regressed.
+    int finish() const
+    {
+        if (options_.json == "-")
+        {
+            write_json(std::cout, results_);
+        }
+        else if (!options_.json.empty())
+        {
+            std::ofstream out(options_.json);
+            write_json(out, results_);
+        }
+        if (!options_.save_baseline.empty())
+        {
+            std::ofstream out(options_.save_baseline);
+            write_json(out, results_);
+        }
+        return options_.baseline.empty() ? EXIT_SUCCESS : compare(read_baseline(options_.baseline));
+    }
+
+private:
+    static void accumulate(counter_values& totals, counter_values const& values)
+    {
+        for (auto const& value : values)
+        {
+            auto it = totals.begin();
+            while (it != totals.end() && it->first != value.first)
+            {
+                ++it;
+            }
+            if (it == totals.end())
+            {
+                totals.push_back(value);
+            }
+            else
+            {
+                it->second += value.second;
+            }
+        }
+    }
+
+    static void report(result const& r)
+    {
+        std::ostringstream line;
+        line << std::left << std::setw(52) << r.name << std::right << std::fixed << std::setprecision(2)
+             << std::setw(12) << r.ns_per_iteration() << " ns/op"
+             << "  min " << std::setprecision(0) << r.min_ns / 1000 << "us"
+             << "  median " << r.median_ns / 1000 << "us"
+             << "  stddev " << std::setprecision(1) << (r.mean_ns > 0 ? 100 * r.stddev_ns / r.mean_ns : 0) << "%";
+        if (!r.counters.empty())
+        {
+            // per operation
+            line << std::setprecision(2);
+            if (r.ipc() >= 0)
+            {
+                line << "  IPC " << r.ipc();
+            }
+            static char const* const events[][2] = {{"instructions", "instr"},
+                                                    {"branch_misses", "br-miss"},
+                                                    {"l1d_misses", "L1d-miss"},
+                                                    {"llc_misses", "LLC-miss"}};
+            for (auto const& event : events)
+            {
+                double const value = r.counter(event[0]);
+                if (value >= 0)
+                {
+                    line << "  " << event[1] << " " << value;
+                }
+            }
+        }
+        std::cerr << line.str() << std::endl;
+    }
+
+    int compare(std::map<std::string, double> const& baseline) const
+    {
+        if (baseline.empty())
+        {
+            std::cerr << "no baseline results in " << options_.baseline << std::endl;
+            return EXIT_FAILURE;
+        }
+        int status = EXIT_SUCCESS;
+        for (result const& r : results_)
+        {
+            auto const it = baseline.find(r.name);
+            if (it == baseline.end() || it->second <= 0)
+            {
+                continue;
+            }
+            double const change = r.ns_per_iteration() / it->second - 1;
+            bool const regressed = change > options_.threshold;
+            std::ostringstream line;
+            line << std::left << std::setw(52) << r.name << std::right << std::fixed << std::setprecision(1)
+                 << std::showpos << std::setw(8) << 100 * change << "%" << std::noshowpos
+                 << (regressed ? "  REGRESSION" : "");
+            std::cerr << line.str() << std::endl;
+            if (regressed)
+            {
+                status = EXIT_FAILURE;
+            }
+        }
+        return status;
+    }
+
+    options const options_;
+    std::unique_ptr<perf_counters> counters_;
+    std::vector<result> results_;
+};
+
+} // namespace bench
@@ -0,0 +1,141 @@
+#pragma once
+
+// Hardware performance counters for the benchmark harness, read through
+// Linux perf_event_open. Each counter is opened on its own so that a
+// missing event (for example LLC misses in a virtual machine) does not take
+// the others with it. Where perf events are not permitted, as in most
+// containers, or on other platforms, no counter is available and the
+// harness reports timings only.
+//
+// Counters measure user space in the calling thread only.
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/perf_event.h>)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#define BENCH_HAVE_PERF_EVENTS
+#endif
+#endif
+
+namespace bench {
+
+// Event counts of one measurement, scaled for time the kernel multiplexed
+// the counter out. Absent counters are not listed.
+using counter_values = std::vector<std::pair<std::string, double>>;
+
+class perf_counters
+{
+public:
+    perf_counters()
+    {
+#ifdef BENCH_HAVE_PERF_EVENTS
+        open("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        open("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        open("branches", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS);
+        open("branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        open("l1d_misses", PERF_TYPE_HW_CACHE,
+             PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+        open("llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+#endif
+    }
+
+    ~perf_counters()
+    {
+#ifdef BENCH_HAVE_PERF_EVENTS
+        for (counter const& c : counters_)
+        {
+            ::close(c.fd);
+        }
+#endif
+    }
+
+    perf_counters(perf_counters const&) = delete;
+    perf_counters& operator=(perf_counters const&) = delete;
+
+    bool available() const { return !counters_.empty(); }
+
+    // Resets the counters and starts counting.
+    void start()
+    {
+#ifdef BENCH_HAVE_PERF_EVENTS
+        for (counter const& c : counters_)
+        {
+            ::ioctl(c.fd, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(c.fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void stop()
+    {
+#ifdef BENCH_HAVE_PERF_EVENTS
+        for (counter const& c : counters_)
+        {
+            ::ioctl(c.fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+#endif
+    }
+
+    // Returns the counts since the last start().
+    counter_values read() const
+    {
+        counter_values values;
+#ifdef BENCH_HAVE_PERF_EVENTS
+        for (counter const& c : counters_)
+        {
+            // value, time enabled, time running
+            std::uint64_t data[3] = {0, 0, 0};
+            if (::read(c.fd, data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0)
+            {
+                continue;
+            }
+            double value = static_cast<double>(data[0]);
+            if (data[2] < data[1])
+            {
+                value *= static_cast<double>(data[1]) / static_cast<double>(data[2]);
+            }
+            values.emplace_back(c.name, value);
+        }
+#endif
+        return values;
+    }
+
+private:
+    struct counter
+    {
+        char const* name;
+        int fd;
+    };
+
+#ifdef BENCH_HAVE_PERF_EVENTS
+    void open(char const* name, std::uint32_t type, std::uint64_t config)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        long const fd = ::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd >= 0)
+        {
+            counters_.push_back(counter{name, static_cast<int>(fd)});
+        }
+    }
+#endif
+
+    std::vector<counter> counters_;
+};
+
+} // namespace bench
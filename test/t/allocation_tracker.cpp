@@ -0,0 +1,87 @@
+// Tracking changes the definition of recursive_wrapper, so these tests are
+// built as a program of their own with the macro defined on the command line.
+#ifndef MAPBOX_VARIANT_TRACK_ALLOCATIONS
+#error "build with -DMAPBOX_VARIANT_TRACK_ALLOCATIONS"
+#endif
+
+#include "catch.hpp"
+
+#include <mapbox/variant.hpp>
+
+#include <type_traits>
+#include <utility>
+
+namespace {
+
+struct cons;
+
+} // namespace
+
+namespace mapbox {
+namespace util {
+
+template <>
+struct bounded_teardown<cons> : std::true_type
+{
+};
+
+} // namespace util
+} // namespace mapbox
+
+namespace {
+
+using list = mapbox::util::variant<int, mapbox::util::recursive_wrapper<cons>>;
+
+struct cons
+{
+    int head;
+    list tail;
+};
+
+list make_list(int length)
+{
+    list l{0};
+    for (int i = 0; i < length; ++i)
+    {
+        l = cons{i, std::move(l)};
+    }
+    return l;
+}
+
+} // namespace
+
+TEST_CASE("allocation tracker counts live and peak recursive_wrapper nodes", "[allocation_tracker]")
+{
+    mapbox::util::allocation_stats const before = mapbox::util::recursive_wrapper_allocations<cons>();
+    REQUIRE(before.live_nodes == 0);
+
+    {
+        list const l = make_list(10);
+        mapbox::util::allocation_stats const stats = mapbox::util::recursive_wrapper_allocations<cons>();
+        REQUIRE(stats.live_nodes == 10);
+        REQUIRE(stats.live_bytes == 10 * sizeof(cons));
+        REQUIRE(stats.allocations >= before.allocations + 10);
+
+        list const copy = l;
+        REQUIRE(mapbox::util::recursive_wrapper_allocations<cons>().live_nodes == 20);
+        REQUIRE(mapbox::util::recursive_wrapper_allocations().live_nodes >= 20);
+    }
+
+    mapbox::util::allocation_stats const after = mapbox::util::recursive_wrapper_allocations<cons>();
+    REQUIRE(after.live_nodes == 0);
+    REQUIRE(after.live_bytes == 0);
+    REQUIRE(after.peak_nodes >= 20);
+    REQUIRE(after.peak_bytes == after.peak_nodes * sizeof(cons));
+
+    mapbox::util::reset_recursive_wrapper_peaks<cons>();
+    REQUIRE(mapbox::util::recursive_wrapper_allocations<cons>().peak_nodes == 0);
+}
+
+TEST_CASE("allocation tracker counts nodes destroyed from the teardown work list", "[allocation_tracker]")
+{
+    {
+        list const l = make_list(10000);
+        REQUIRE(mapbox::util::recursive_wrapper_allocations<cons>().live_nodes == 10000);
+    }
+    REQUIRE(mapbox::util::recursive_wrapper_allocations<cons>().live_nodes == 0);
+}
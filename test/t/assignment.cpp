@@ -0,0 +1,306 @@
+#include "catch.hpp"
+
+#include <mapbox/variant.hpp>
+#include <mapbox/recursive_wrapper.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+struct counters
+{
+    int constructed = 0;
+    int copy_assigned = 0;
+    int move_assigned = 0;
+};
+
+counters count;
+
+struct counted
+{
+    int value;
+
+    counted(int v) : value(v) { ++count.constructed; }
+    counted(counted const& rhs) : value(rhs.value) { ++count.constructed; }
+    counted(counted&& rhs) noexcept : value(rhs.value) { ++count.constructed; }
+
+    counted& operator=(counted const& rhs)
+    {
+        value = rhs.value;
+        ++count.copy_assigned;
+        return *this;
+    }
+
+    counted& operator=(counted&& rhs)
+    {
+        value = rhs.value;
+        ++count.move_assigned;
+        return *this;
+    }
+};
+
+// Its converting constructor throws if asked to.
+struct converted
+{
+    std::string value;
+
+    converted(std::string v) : value(std::move(v)) {}
+    converted(char const* v) : value(v)
+    {
+        if (value == "throw") throw std::runtime_error("convert");
+    }
+};
+
+struct not_assignable
+{
+    int const value;
+
+    not_assignable(int v) : value(v) {}
+};
+
+struct named;
+
+using name_or_named = mapbox::util::variant<std::string, mapbox::util::recursive_wrapper<named>>;
+
+struct named
+{
+    std::string name;
+};
+
+struct big;
+struct big_node;
+
+using big_or_node = mapbox::util::variant<big, mapbox::util::recursive_wrapper<big_node>>;
+
+// Its move constructor may throw, and throws if asked to.
+struct big
+{
+    std::string value;
+    bool throw_on_move = false;
+
+    big(std::string v) : value(std::move(v)) {}
+    big(big const& rhs) : value(rhs.value), throw_on_move(rhs.throw_on_move) {}
+    big(big&& rhs) noexcept(false)
+        : value(std::move(rhs.value)), throw_on_move(rhs.throw_on_move)
+    {
+        if (throw_on_move) throw std::runtime_error("move");
+    }
+    big& operator=(big const&) = delete;
+};
+
+struct big_node
+{
+    big a;
+    big b;
+};
+
+struct node;
+
+using tree = mapbox::util::variant<int, mapbox::util::recursive_wrapper<node>>;
+
+struct node
+{
+    tree left;
+    tree right;
+};
+
+} // namespace
+
+TEST_CASE("assigning a variant holding the same type assigns in place", "[variant][assignment]")
+{
+    using variant_type = mapbox::util::variant<int, counted>;
+    variant_type a{counted{1}};
+    variant_type b{counted{2}};
+
+    count = counters();
+    a = b;
+    REQUIRE(a.get<counted>().value == 2);
+    REQUIRE(count.constructed == 0);
+    REQUIRE(count.copy_assigned == 1);
+
+    count = counters();
+    a = std::move(b);
+    REQUIRE(a.get<counted>().value == 2);
+    REQUIRE(count.constructed == 0);
+    REQUIRE(count.move_assigned == 1);
+}
+
+TEST_CASE("assigning a variant holding another type constructs the value", "[variant][assignment]")
+{
+    using variant_type = mapbox::util::variant<int, counted>;
+    variant_type a{1};
+    variant_type b{counted{2}};
+
+    count = counters();
+    a = b;
+    REQUIRE(a.get<counted>().value == 2);
+    REQUIRE(count.constructed == 1);
+    REQUIRE(count.copy_assigned == 0);
+
+    b = 3;
+    a = b;
+    REQUIRE(a.get<int>() == 3);
+}
+
+TEST_CASE("assigning an rvalue of another type constructs it in place", "[variant][assignment]")
+{
+    using variant_type = mapbox::util::variant<int, counted>;
+    variant_type a{1};
+    counted c{2};
+
+    count = counters();
+    a = std::move(c);
+    REQUIRE(a.get<counted>().value == 2);
+    REQUIRE(count.constructed == 1);
+
+    a = 3;
+    REQUIRE(a.get<int>() == 3);
+
+    // an lvalue may refer into the held value, so it goes through a
+    // temporary
+    count = counters();
+    a = c;
+    REQUIRE(a.get<counted>().value == 2);
+    REQUIRE(count.constructed == 2);
+}
+
+TEST_CASE("converting assignment of the held type assigns in place", "[variant][assignment]")
+{
+    using variant_type = mapbox::util::variant<int, counted>;
+    variant_type v{counted{1}};
+    counted const c{2};
+
+    count = counters();
+    v = c;
+    REQUIRE(v.get<counted>().value == 2);
+    REQUIRE(count.constructed == 0);
+    REQUIRE(count.copy_assigned == 1);
+
+    count = counters();
+    v = counted{3};
+    REQUIRE(v.get<counted>().value == 3);
+    REQUIRE(count.constructed == 1); // the temporary only
+    REQUIRE(count.move_assigned == 1);
+
+    v = 4;
+    REQUIRE(v.get<int>() == 4);
+}
+
+TEST_CASE("assigning a string reuses its buffer", "[variant][assignment]")
+{
+    using variant_type = mapbox::util::variant<int, double, std::string>;
+    std::string const value(100, 'x');
+    variant_type v{1};
+
+    v = std::string(100, 'y');
+    REQUIRE(v.get<std::string>() == std::string(100, 'y'));
+    char const* buffer = v.get<std::string>().data();
+
+    v = value;
+    REQUIRE(v.get<std::string>() == value);
+    REQUIRE(v.get<std::string>().data() == buffer);
+
+    variant_type const w{std::string(60, 'z')};
+    v = w;
+    REQUIRE(v.get<std::string>() == w.get<std::string>());
+    REQUIRE(v.get<std::string>().data() == buffer);
+}
+
+TEST_CASE("types without assignment operator can be assigned", "[variant][assignment]")
+{
+    using variant_type = mapbox::util::variant<int, not_assignable>;
+    variant_type a{not_assignable{1}};
+    variant_type b{not_assignable{2}};
+
+    a = b;
+    REQUIRE(a.get<not_assignable>().value == 2);
+
+    a = std::move(b);
+    REQUIRE(a.get<not_assignable>().value == 2);
+
+    a = not_assignable{3};
+    REQUIRE(a.get<not_assignable>().value == 3);
+}
+
+TEST_CASE("assigning a value from inside the variant", "[variant][assignment]")
+{
+    tree t{node{tree{1}, tree{node{tree{2}, tree{3}}}}};
+
+    t = t.get<node>().left.get<int>();
+    REQUIRE(t.get<int>() == 1);
+
+    name_or_named n{named{std::string(100, 'n')}};
+    n = n.get<named>().name;
+    REQUIRE(n.get<std::string>() == std::string(100, 'n'));
+
+    std::string s{"self"};
+    mapbox::util::variant<int, std::string> v{s};
+    v = v.get<std::string>();
+    REQUIRE(v.get<std::string>() == s);
+}
+
+TEST_CASE("assigning a child variant of the held value", "[variant][assignment]")
+{
+    tree t{node{tree{1}, tree{node{tree{2}, tree{3}}}}};
+    t = t.get<node>().left;
+    REQUIRE(t.get<int>() == 1);
+
+    t = node{tree{1}, tree{node{tree{2}, tree{3}}}};
+    t = t.get<node>().right;
+    REQUIRE(t.get<node>().left.get<int>() == 2);
+    REQUIRE(t.get<node>().right.get<int>() == 3);
+
+    t = node{tree{1}, tree{node{tree{2}, tree{3}}}};
+    t = std::move(t.get<node>().left);
+    REQUIRE(t.get<int>() == 1);
+
+    t = node{tree{1}, tree{node{tree{2}, tree{3}}}};
+    t = std::move(t.get<node>().right);
+    REQUIRE(t.get<node>().left.get<int>() == 2);
+    REQUIRE(t.get<node>().right.get<int>() == 3);
+
+    t = node{tree{1}, tree{node{tree{2}, tree{3}}}};
+    t = std::move(t.get<node>().right.get<node>());
+    REQUIRE(t.get<node>().left.get<int>() == 2);
+    REQUIRE(t.get<node>().right.get<int>() == 3);
+}
+
+TEST_CASE("moving a value out of the variant into it", "[variant][assignment]")
+{
+    name_or_named n{named{std::string(100, 'n')}};
+    n = std::move(n.get<named>().name);
+    REQUIRE(n.get<std::string>() == std::string(100, 'n'));
+
+    big_or_node v{big_node{big{std::string(100, 'a')}, big{std::string(100, 'b')}}};
+    v = std::move(v.get<big_node>().b);
+    REQUIRE(v.get<big>().value == std::string(100, 'b'));
+}
+
+TEST_CASE("a throwing converting constructor leaves the old value", "[variant][assignment]")
+{
+    mapbox::util::variant<int, converted> v{1};
+    REQUIRE_THROWS_AS(v = "throw", std::runtime_error&);
+    REQUIRE(v.get<int>() == 1);
+
+    v = "abc";
+    REQUIRE(v.get<converted>().value == "abc");
+}
+
+TEST_CASE("assigning a value from inside the variant whose move may throw", "[variant][assignment]")
+{
+    big_or_node v{big_node{big{std::string(100, 'a')}, big{std::string(100, 'b')}}};
+    v = v.get<big_node>().b;
+    REQUIRE(v.get<big>().value == std::string(100, 'b'));
+}
+
+TEST_CASE("a throwing move during assignment leaves the variant invalid", "[variant][assignment]")
+{
+    big_or_node v{big_node{big{"a"}, big{"b"}}};
+    big value{"c"};
+    value.throw_on_move = true;
+    REQUIRE_THROWS_AS(v = value, std::runtime_error&);
+    REQUIRE_FALSE(v.valid());
+    REQUIRE(value.value == "c");
+}
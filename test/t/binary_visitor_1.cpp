@@ -5,3 +5,66 @@
 using variant_type = mapbox::util::variant<int, double>;
 
 #include "binary_visitor_impl.hpp"
+
+namespace {
+
+template <int N>
+struct tag
+{
+    int visits = 0;
+};
+
+struct tag_pair
+{
+    template <int M, int N>
+    int operator()(tag<M> const&, tag<N> const&) const
+    {
+        return M * 100 + N;
+    }
+};
+
+struct count_visits
+{
+    template <int M, int N>
+    void operator()(tag<M>& lhs, tag<N>& rhs) const
+    {
+        lhs.visits += 1;
+        rhs.visits += 10;
+    }
+};
+
+// 32 * 32 entries, deeper than the default template instantiation limit if
+// the index sequence were built one index at a time
+using large_variant = mapbox::util::variant<tag<0>, tag<1>, tag<2>, tag<3>, tag<4>, tag<5>, tag<6>, tag<7>,
+                                            tag<8>, tag<9>, tag<10>, tag<11>, tag<12>, tag<13>, tag<14>, tag<15>,
+                                            tag<16>, tag<17>, tag<18>, tag<19>, tag<20>, tag<21>, tag<22>, tag<23>,
+                                            tag<24>, tag<25>, tag<26>, tag<27>, tag<28>, tag<29>, tag<30>, tag<31>>;
+
+static_assert(std::tuple_size<large_variant::types>::value > MAPBOX_VARIANT_BINARY_DISPATCH_TABLE_THRESHOLD,
+              "variant must be large enough to use table dispatch");
+
+} // namespace
+
+TEST_CASE("binary visitor works on variants with a large pair table", "[visitor][binary visitor]")
+{
+    REQUIRE(mapbox::util::apply_visitor(tag_pair{}, large_variant{tag<0>{}}, large_variant{tag<31>{}}) == 31);
+    REQUIRE(mapbox::util::apply_visitor(tag_pair{}, large_variant{tag<17>{}}, large_variant{tag<5>{}}) == 1705);
+    REQUIRE(mapbox::util::apply_visitor(tag_pair{}, large_variant{tag<31>{}}, large_variant{tag<31>{}}) == 3131);
+}
+
+TEST_CASE("mutating binary visitor works on variants with a large pair table", "[visitor][binary visitor]")
+{
+    large_variant a{tag<3>{}};
+    large_variant b{tag<20>{}};
+
+    mapbox::util::apply_visitor(count_visits{}, a, b);
+    REQUIRE(a.get<tag<3>>().visits == 1);
+    REQUIRE(b.get<tag<20>>().visits == 10);
+
+    mapbox::util::apply_visitor(count_visits{}, b, a);
+    REQUIRE(a.get<tag<3>>().visits == 11);
+    REQUIRE(b.get<tag<20>>().visits == 11);
+
+    mapbox::util::apply_visitor(count_visits{}, a, a);
+    REQUIRE(a.get<tag<3>>().visits == 22);
+}
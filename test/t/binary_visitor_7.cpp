@@ -0,0 +1,10 @@
+
+#include <mapbox/variant.hpp>
+
+#define NAME_EXT " b-i-d-c-s-l-f-sc-ll"
+using variant_type = mapbox::util::variant<bool, int, double, char, short int, long int, float, signed char, long long int>;
+
+static_assert(std::tuple_size<variant_type::types>::value > MAPBOX_VARIANT_BINARY_DISPATCH_TABLE_THRESHOLD,
+              "variant must be large enough to use table dispatch");
+
+#include "binary_visitor_impl.hpp"
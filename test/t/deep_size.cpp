@@ -0,0 +1,106 @@
+#include "catch.hpp"
+
+#include <mapbox/deep_size.hpp>
+#include <mapbox/variant.hpp>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+struct branch;
+
+using tree = mapbox::util::variant<int, std::string, mapbox::util::recursive_wrapper<branch>>;
+
+struct branch
+{
+    std::vector<tree> children;
+};
+
+struct shared_branch;
+
+using shared_tree = mapbox::util::variant<int, mapbox::util::shared_recursive_wrapper<shared_branch>>;
+
+struct shared_branch
+{
+    shared_tree left;
+    shared_tree right;
+};
+
+} // namespace
+
+namespace mapbox {
+namespace util {
+
+template <>
+struct heap_size<branch>
+{
+    static std::size_t of(branch const& b, heap_size_counter& count)
+    {
+        return count(b.children);
+    }
+};
+
+template <>
+struct heap_size<shared_branch>
+{
+    static std::size_t of(shared_branch const& b, heap_size_counter& count)
+    {
+        return count(b.left) + count(b.right);
+    }
+};
+
+} // namespace util
+} // namespace mapbox
+
+TEST_CASE("deep_size_of counts heap memory of strings and vectors", "[deep_size]")
+{
+    std::string const small = "s";
+    std::string const large(1000, 'x');
+    REQUIRE(mapbox::util::heap_size_of(small) == 0);
+    REQUIRE(mapbox::util::heap_size_of(large) == large.capacity() + 1);
+    REQUIRE(mapbox::util::deep_size_of(large) == sizeof(std::string) + large.capacity() + 1);
+
+    std::vector<std::string> strings;
+    strings.reserve(4);
+    strings.push_back(small);
+    strings.push_back(large);
+    REQUIRE(mapbox::util::heap_size_of(strings) == 4 * sizeof(std::string) + large.capacity() + 1);
+}
+
+TEST_CASE("deep_size_of counts recursive_wrapper nodes and their contents", "[deep_size]")
+{
+    std::string const text(100, 'x');
+    REQUIRE(mapbox::util::heap_size_of(tree{1}) == 0);
+    REQUIRE(mapbox::util::heap_size_of(tree{text}) == mapbox::util::heap_size_of(text));
+
+    branch inner;
+    inner.children.reserve(2);
+    inner.children.emplace_back(2);
+    inner.children.emplace_back(text);
+    branch outer;
+    outer.children.reserve(1);
+    outer.children.emplace_back(inner);
+    tree const t{outer};
+
+    std::size_t const expected = 2 * sizeof(branch) + 3 * sizeof(tree) + mapbox::util::heap_size_of(text);
+    REQUIRE(mapbox::util::heap_size_of(t) == expected);
+    REQUIRE(mapbox::util::deep_size_of(t) == sizeof(tree) + expected);
+
+    mapbox::util::heap_size_counter count;
+    count(t);
+    REQUIRE(count.nodes() == 2);
+    REQUIRE((count.depth_histogram() == std::vector<std::size_t>{1, 1}));
+}
+
+TEST_CASE("deep_size_of counts shared values once", "[deep_size]")
+{
+    using wrapper = mapbox::util::shared_recursive_wrapper<shared_branch>;
+    shared_tree const leaf{shared_branch{shared_tree{1}, shared_tree{2}}};
+    shared_tree const root{shared_branch{leaf, leaf}};
+
+    mapbox::util::heap_size_counter count;
+    REQUIRE(count(root) == 2 * wrapper::node_size());
+    REQUIRE(count.nodes() == 2);
+    REQUIRE((count.depth_histogram() == std::vector<std::size_t>{1, 1}));
+}
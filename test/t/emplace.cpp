@@ -0,0 +1,128 @@
+#include "catch.hpp"
+
+#include <mapbox/variant.hpp>
+
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// can only be constructed in place
+struct immovable
+{
+    int a;
+    std::string b;
+
+    immovable(int a_, std::string b_) : a(a_), b(std::move(b_)) {}
+    immovable(immovable const&) = delete;
+    immovable(immovable&&) = delete;
+    immovable& operator=(immovable const&) = delete;
+    immovable& operator=(immovable&&) = delete;
+};
+
+struct throwing
+{
+    throwing(int) { throw std::runtime_error("throwing"); }
+};
+
+} // namespace
+
+TEST_CASE("variant can be constructed in place by type", "[variant][emplace]")
+{
+    using variant_type = mapbox::util::variant<int, immovable>;
+    variant_type const v{mapbox::util::in_place_type_t<immovable>{}, 1, "one"};
+    REQUIRE(v.is<immovable>());
+    REQUIRE(v.get<immovable>().a == 1);
+    REQUIRE(v.get<immovable>().b == "one");
+
+    variant_type const w{mapbox::util::in_place_type_t<int>{}};
+    REQUIRE(w.get<int>() == 0);
+}
+
+TEST_CASE("variant can be constructed in place by index", "[variant][emplace]")
+{
+    using variant_type = mapbox::util::variant<int, std::string, double>;
+    variant_type const v{mapbox::util::in_place_index_t<1>{}, 3u, 'x'};
+    REQUIRE(v.which() == 1);
+    REQUIRE(v.get<std::string>() == "xxx");
+
+    variant_type const w{mapbox::util::in_place_index_t<2>{}, 1.5};
+    REQUIRE(w.get<double>() == 1.5);
+}
+
+#if __cplusplus >= 201402L
+TEST_CASE("in place tags are available as variables", "[variant][emplace]")
+{
+    using variant_type = mapbox::util::variant<int, immovable>;
+    variant_type const v{mapbox::util::in_place_type<immovable>, 1, "one"};
+    REQUIRE(v.is<immovable>());
+
+    variant_type const w{mapbox::util::in_place_index<0>, 7};
+    REQUIRE(w.get<int>() == 7);
+}
+#endif
+
+TEST_CASE("emplace replaces the value and returns it", "[variant][emplace]")
+{
+    using variant_type = mapbox::util::variant<int, immovable>;
+    variant_type v{5};
+
+    immovable& i = v.emplace<immovable>(2, "two");
+    REQUIRE(&i == &v.get<immovable>());
+    REQUIRE(i.b == "two");
+
+    REQUIRE(v.emplace<immovable>(3, "three").a == 3);
+    REQUIRE(v.get<immovable>().b == "three");
+
+    int& n = v.emplace<0>(4);
+    REQUIRE(n == 4);
+    REQUIRE(v.get<int>() == 4);
+
+    v.emplace<1>(5, "five");
+    REQUIRE(v.get<immovable>().b == "five");
+}
+
+namespace {
+
+struct which_visitor
+{
+    int operator()(int) const { return 0; }
+    int operator()(std::string const&) const { return 1; }
+    int operator()(double) const { return 3; }
+};
+
+} // namespace
+
+TEST_CASE("duplicated types are held as their first occurrence", "[variant][emplace]")
+{
+    using variant_type = mapbox::util::variant<int, std::string, std::string, double>;
+    variant_type v{mapbox::util::in_place_type_t<std::string>{}, "hello"};
+    REQUIRE(v.which() == 1);
+    REQUIRE(mapbox::util::apply_visitor(which_visitor{}, v) == 1);
+
+    variant_type w{0};
+    w = v;
+    REQUIRE(w.which() == 1);
+    REQUIRE(w == v);
+    REQUIRE_FALSE(w < v);
+
+    w.emplace<std::string>("world");
+    REQUIRE(w.which() == 1);
+    REQUIRE(w.get<std::string>() == "world");
+    REQUIRE(w != v);
+    REQUIRE(mapbox::util::apply_visitor(which_visitor{}, w) == 1);
+
+    w.emplace<3>(2.5);
+    REQUIRE(mapbox::util::apply_visitor(which_visitor{}, w) == 3);
+}
+
+TEST_CASE("emplace leaves the variant invalid if construction throws", "[variant][emplace]")
+{
+    using variant_type = mapbox::util::variant<int, throwing>;
+    variant_type v{1};
+    REQUIRE_THROWS_AS(v.emplace<throwing>(2), std::runtime_error&);
+    REQUIRE_FALSE(v.valid());
+
+    v.emplace<int>(3);
+    REQUIRE(v.get<int>() == 3);
+}
@@ -0,0 +1,198 @@
+// Instrumentation changes the definition of variant, so these tests are
+// built as a program of their own with the macro defined on the command line.
+#ifndef MAPBOX_VARIANT_INSTRUMENTATION
+#error "build with -DMAPBOX_VARIANT_INSTRUMENTATION"
+#endif
+
+#include "catch.hpp"
+
+#include <mapbox/variant.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct circle
+{
+    double radius;
+};
+
+struct square
+{
+    double side;
+};
+
+struct label
+{
+    std::string text;
+};
+
+using shape = mapbox::util::variant<circle, square, label>;
+
+// All alternatives trivially copyable, so that copy and assignment of the
+// variant would otherwise be trivial.
+struct small
+{
+    int value;
+};
+
+struct large
+{
+    long value;
+};
+
+using number = mapbox::util::variant<small, large>;
+
+struct area
+{
+    double operator()(circle const& c) const { return 3 * c.radius * c.radius; }
+    double operator()(square const& s) const { return s.side * s.side; }
+    double operator()(label const&) const { return 0; }
+};
+
+struct same
+{
+    template <typename T>
+    bool operator()(T const&, T const&) const { return true; }
+
+    template <typename T, typename U>
+    bool operator()(T const&, U const&) const { return false; }
+};
+
+} // namespace
+
+TEST_CASE("instrumentation counts visits of each alternative", "[instrumentation]")
+{
+    mapbox::util::reset_instrumentation();
+    shape const c{circle{1}};
+    shape s{square{2}};
+
+    mapbox::util::apply_visitor(area(), c);
+    mapbox::util::apply_visitor(area(), s);
+    s.match([](circle const&) {}, [](square const&) {}, [](label const&) {});
+    mapbox::util::apply_visitor(same(), c, s);
+
+    mapbox::util::variant_counts const counts = mapbox::util::instrumentation_counts<shape>();
+    REQUIRE(counts.alternatives.size() == 3);
+    REQUIRE(counts.visits[0] == 2);
+    REQUIRE(counts.visits[1] == 3);
+    REQUIRE(counts.visits[2] == 0);
+}
+
+TEST_CASE("instrumentation counts checked gets only", "[instrumentation]")
+{
+    mapbox::util::reset_instrumentation();
+    shape s{label{"text"}};
+
+    REQUIRE(s.get<label>().text == "text");
+    REQUIRE(s.get_unchecked<label>().text == "text");
+
+    mapbox::util::variant_counts const counts = mapbox::util::instrumentation_counts<shape>();
+    REQUIRE(counts.gets[0] == 0);
+    REQUIRE(counts.gets[1] == 0);
+    REQUIRE(counts.gets[2] == 1);
+}
+
+TEST_CASE("instrumentation does not count failed gets", "[instrumentation]")
+{
+    mapbox::util::reset_instrumentation();
+    shape s{label{"text"}};
+    shape const& c = s;
+
+    REQUIRE_THROWS_AS(s.get<circle>(), mapbox::util::bad_variant_access&);
+    REQUIRE_THROWS_AS(c.get<square>(), mapbox::util::bad_variant_access&);
+
+    mapbox::util::variant_counts const counts = mapbox::util::instrumentation_counts<shape>();
+    REQUIRE(counts.gets[0] == 0);
+    REQUIRE(counts.gets[1] == 0);
+    REQUIRE(counts.gets[2] == 0);
+}
+
+TEST_CASE("instrumentation records type transitions on assignment", "[instrumentation]")
+{
+    mapbox::util::reset_instrumentation();
+    shape s{circle{1}};
+
+    s = circle{2};                 // circle -> circle
+    s = square{3};                 // circle -> square
+    s = shape{label{"text"}};      // square -> label
+    s.emplace<circle>(circle{4});  // label -> circle
+    shape const other{circle{5}};
+    s = other;                     // circle -> circle
+
+    mapbox::util::variant_counts const counts = mapbox::util::instrumentation_counts<shape>();
+    REQUIRE(counts.assignments[0] == 3);
+    REQUIRE(counts.assignments[1] == 1);
+    REQUIRE(counts.assignments[2] == 1);
+    REQUIRE(counts.transitions[0][0] == 2);
+    REQUIRE(counts.transitions[0][1] == 1);
+    REQUIRE(counts.transitions[1][2] == 1);
+    REQUIRE(counts.transitions[2][0] == 1);
+    REQUIRE(counts.same_type_assignments() == 2);
+}
+
+TEST_CASE("instrumentation counts assignment of trivially copyable variants", "[instrumentation]")
+{
+    mapbox::util::reset_instrumentation();
+    number n{small{1}};
+    number const l{large{2}};
+
+    n = l;
+    n = number{small{3}};
+    REQUIRE(n.get<small>().value == 3);
+
+    mapbox::util::variant_counts const counts = mapbox::util::instrumentation_counts<number>();
+    REQUIRE(counts.transitions[0][1] == 1);
+    REQUIRE(counts.transitions[1][0] == 1);
+    REQUIRE(counts.gets[0] == 1);
+}
+
+TEST_CASE("instrumentation ignores assignment from an invalid variant", "[instrumentation]")
+{
+    mapbox::util::reset_instrumentation();
+    shape s{circle{1}};
+    shape const invalid{mapbox::util::no_init()};
+
+    s = invalid;
+    REQUIRE_FALSE(s.valid());
+    s = shape{mapbox::util::no_init()};
+    s = square{2};                 // invalid -> square
+
+    mapbox::util::variant_counts const counts = mapbox::util::instrumentation_counts<shape>();
+    REQUIRE(counts.assignments[0] == 0);
+    REQUIRE(counts.assignments[1] == 1);
+    REQUIRE(counts.assignments[2] == 0);
+    REQUIRE(counts.same_type_assignments() == 0);
+}
+
+TEST_CASE("instrumentation lists variant types by use and resets", "[instrumentation]")
+{
+    mapbox::util::reset_instrumentation();
+    shape s{circle{1}};
+    number n{small{1}};
+    for (int i = 0; i < 10; ++i)
+    {
+        mapbox::util::apply_visitor(area(), s);
+    }
+    n = large{2};
+
+    std::vector<mapbox::util::variant_counts> const all = mapbox::util::instrumentation_counts();
+    REQUIRE(all.size() >= 2);
+    REQUIRE(all[0].type == mapbox::util::instrumentation_counts<shape>().type);
+    REQUIRE(all[0].total() == 10);
+    REQUIRE(all[1].total() == 1);
+
+    std::ostringstream out;
+    mapbox::util::dump_instrumentation(out);
+    std::string const table = out.str();
+    REQUIRE(table.find(all[0].type) < table.find(all[1].type));
+    REQUIRE(table.find("assignments") != std::string::npos);
+
+    mapbox::util::reset_instrumentation();
+    REQUIRE(mapbox::util::instrumentation_counts<shape>().total() == 0);
+    std::ostringstream empty;
+    mapbox::util::dump_instrumentation(empty);
+    REQUIRE(empty.str().empty());
+}
@@ -0,0 +1,146 @@
+#include "catch.hpp"
+
+#include <mapbox/interner.hpp>
+#include <mapbox/variant.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct add;
+
+using expression = mapbox::util::variant<int, std::string, mapbox::util::shared_recursive_wrapper<add>>;
+
+struct add
+{
+    expression left;
+    expression right;
+
+    bool operator==(add const& rhs) const
+    {
+        return left == rhs.left && right == rhs.right;
+    }
+};
+
+struct add_hash
+{
+    std::size_t operator()(add const& node) const
+    {
+        mapbox::util::identity_hash hash;
+        return hash(node.left) * 31 + hash(node.right);
+    }
+};
+
+struct add_equal
+{
+    bool operator()(add const& lhs, add const& rhs) const
+    {
+        mapbox::util::identity_equal equal;
+        return equal(lhs.left, rhs.left) && equal(lhs.right, rhs.right);
+    }
+};
+
+using add_interner = mapbox::util::interner<add, add_hash, add_equal>;
+
+expression make_sum(add_interner& interner, int depth)
+{
+    if (depth == 0)
+    {
+        return expression{1};
+    }
+    return expression{interner.intern(add{make_sum(interner, depth - 1), make_sum(interner, depth - 1)})};
+}
+
+int evaluate(expression const& e)
+{
+    return e.match([](int value) { return value; },
+                   [](std::string const&) { return 0; },
+                   [](add const& a) { return evaluate(a.left) + evaluate(a.right); });
+}
+
+// Evaluates each distinct node once.
+struct memoized_evaluator
+{
+    add_interner const& interner;
+    std::vector<int> results;
+    int evaluated;
+
+    int operator()(expression const& e)
+    {
+        return e.match([](int value) { return value; },
+                       [](std::string const&) { return 0; },
+                       [this](add const& a) {
+                           std::size_t const id = interner.id(a);
+                           if (id < results.size() && results[id] != 0)
+                           {
+                               return results[id];
+                           }
+                           ++evaluated;
+                           int const result = (*this)(a.left) + (*this)(a.right);
+                           if (id >= results.size())
+                           {
+                               results.resize(id + 1);
+                           }
+                           results[id] = result;
+                           return result;
+                       });
+    }
+};
+
+} // namespace
+
+TEST_CASE("interner shares equal nodes", "[interner]")
+{
+    add_interner interner;
+    expression const a{interner.intern(add{expression{1}, expression{std::string("x")}})};
+    expression const b{interner.intern(add{expression{1}, expression{std::string("x")}})};
+    expression const c{interner.intern(add{expression{2}, expression{std::string("x")}})};
+
+    REQUIRE(interner.size() == 2);
+    REQUIRE(&a.get<add>() == &b.get<add>());
+    REQUIRE(&a.get<add>() != &c.get<add>());
+    REQUIRE(interner.id(a.get<add>()) == 0);
+    REQUIRE(interner.id(b.get<add>()) == 0);
+    REQUIRE(interner.id(c.get<add>()) == 1);
+    REQUIRE(interner.id(add{expression{3}, expression{3}}) == add_interner::npos);
+
+    mapbox::util::identity_equal equal;
+    REQUIRE(equal(a, b));
+    REQUIRE_FALSE(equal(a, c));
+    REQUIRE(mapbox::util::identity_hash()(a) == mapbox::util::identity_hash()(b));
+}
+
+TEST_CASE("interner stores each distinct subtree once", "[interner]")
+{
+    add_interner interner;
+    expression const tree = make_sum(interner, 16);
+    REQUIRE(interner.size() == 16);
+    REQUIRE(make_sum(interner, 16) == tree);
+    REQUIRE(mapbox::util::identity_equal()(make_sum(interner, 16), tree));
+    REQUIRE(interner.size() == 16);
+
+    memoized_evaluator evaluator{interner, {}, 0};
+    REQUIRE(evaluator(tree) == 1 << 16);
+    REQUIRE(evaluator.evaluated == 16);
+}
+
+TEST_CASE("interner collects nodes that are no longer used", "[interner]")
+{
+    add_interner interner;
+    {
+        expression const tree = make_sum(interner, 5);
+        REQUIRE(evaluate(tree) == 32);
+        REQUIRE(interner.collect() == 0);
+    }
+    expression const kept{interner.intern(add{expression{1}, expression{1}})};
+    REQUIRE(interner.size() == 5);
+    REQUIRE(interner.collect() == 4);
+    REQUIRE(interner.size() == 1);
+
+    // ids are not reused
+    expression const again = make_sum(interner, 2);
+    REQUIRE(interner.id(again.get<add>()) == 5);
+    REQUIRE(&again.get<add>().left.get<add>() == &kept.get<add>());
+}
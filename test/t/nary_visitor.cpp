@@ -0,0 +1,124 @@
+#include "catch.hpp"
+
+#include <mapbox/variant.hpp>
+
+#include <string>
+
+struct sum_visitor
+{
+    template <typename A, typename B>
+    double operator()(A a, B b) const
+    {
+        return double(a) + double(b);
+    }
+
+    template <typename A, typename B, typename C>
+    double operator()(A a, B b, C c) const
+    {
+        return double(a) + double(b) + double(c);
+    }
+};
+
+struct describe_visitor
+{
+    template <typename A, typename B>
+    std::string operator()(A const&, B const&) const
+    {
+        return "numbers";
+    }
+
+    template <typename A>
+    std::string operator()(A const&, std::string const& b) const
+    {
+        return "number and " + b;
+    }
+
+    template <typename A>
+    std::string operator()(std::string const& a, A const&) const
+    {
+        return a + " and number";
+    }
+
+    std::string operator()(std::string const& a, std::string const& b) const
+    {
+        return a + " and " + b;
+    }
+};
+
+struct increment_visitor
+{
+    template <typename A, typename B, typename C>
+    void operator()(A& a, B& b, C& c) const
+    {
+        ++a;
+        ++b;
+        ++c;
+    }
+};
+
+TEST_CASE("binary visitor works on variants of different types", "[visitor][n-ary visitor]")
+{
+    using variant_a = mapbox::util::variant<int, std::string>;
+    using variant_b = mapbox::util::variant<double, std::string, long>;
+
+    const variant_a a1{1};
+    const variant_a a2{std::string("foo")};
+    variant_b b1{2.5};
+    variant_b b2{std::string("bar")};
+    variant_b b3{3L};
+
+    REQUIRE(mapbox::util::apply_visitor(describe_visitor{}, a1, b1) == "numbers");
+    REQUIRE(mapbox::util::apply_visitor(describe_visitor{}, a1, b2) == "number and bar");
+    REQUIRE(mapbox::util::apply_visitor(describe_visitor{}, a2, b3) == "foo and number");
+    REQUIRE(mapbox::util::apply_visitor(describe_visitor{}, a2, b2) == "foo and bar");
+    REQUIRE(mapbox::util::apply_visitor(describe_visitor{}, b2, a2) == "bar and foo");
+}
+
+TEST_CASE("ternary visitor works on variants of different types", "[visitor][n-ary visitor]")
+{
+    using variant_a = mapbox::util::variant<int, double>;
+    using variant_b = mapbox::util::variant<bool, long, float>;
+    using variant_c = mapbox::util::variant<short, unsigned char, double, int>;
+
+    const variant_a a1{1};
+    const variant_a a2{0.5};
+    const variant_b b1{true};
+    const variant_b b2{10L};
+    const variant_b b3{0.25f};
+    const variant_c c1{short(100)};
+    const variant_c c2{2.0};
+
+    const sum_visitor v;
+    REQUIRE(mapbox::util::apply_visitor(v, a1, b1, c1) == Approx(102));
+    REQUIRE(mapbox::util::apply_visitor(v, a2, b2, c2) == Approx(12.5));
+    REQUIRE(mapbox::util::apply_visitor(v, a2, b3, c1) == Approx(100.75));
+    REQUIRE(mapbox::util::apply_visitor(sum_visitor{}, a1, a2, a1) == Approx(2.5));
+    REQUIRE(mapbox::util::apply_visitor(v, a1, b2, variant_c{7}) == Approx(18));
+}
+
+TEST_CASE("n-ary visitor can mutate non-const variants", "[visitor][n-ary visitor]")
+{
+    using variant_a = mapbox::util::variant<int, double>;
+    using variant_b = mapbox::util::variant<long, float>;
+
+    variant_a a{1};
+    variant_b b{2.5f};
+    variant_a c{0.5};
+
+    mapbox::util::apply_visitor(increment_visitor{}, a, b, c);
+    REQUIRE(a.get<int>() == 2);
+    REQUIRE(b.get<float>() == Approx(3.5));
+    REQUIRE(c.get<double>() == Approx(1.5));
+}
+
+TEST_CASE("n-ary visitor works with recursive wrappers", "[visitor][n-ary visitor]")
+{
+    using variant_a = mapbox::util::variant<int, mapbox::util::recursive_wrapper<double>>;
+    using variant_b = mapbox::util::variant<mapbox::util::recursive_wrapper<long>, float>;
+
+    const variant_a a{2.5};
+    const variant_b b{4L};
+
+    REQUIRE(mapbox::util::apply_visitor(sum_visitor{}, a, b) == Approx(6.5));
+    REQUIRE(mapbox::util::apply_visitor(sum_visitor{}, b, a, a) == Approx(9));
+}
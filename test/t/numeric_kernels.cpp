@@ -0,0 +1,169 @@
+#include "catch.hpp"
+
+#include <mapbox/numeric_kernels.hpp>
+#include <mapbox/variant.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+using mapbox::util::numeric_column;
+using mapbox::util::numeric_value;
+
+// Values of the given types in random order, with runs of one type.
+std::vector<numeric_value> make_values(std::size_t size, unsigned seed, int first_type, int last_type)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> type(first_type, last_type);
+    std::uniform_int_distribution<int> run(1, 20);
+    std::uniform_int_distribution<std::int64_t> number(-1000, 1000);
+    std::vector<numeric_value> values;
+    while (values.size() < size)
+    {
+        int const t = type(gen);
+        for (int n = run(gen); n > 0 && values.size() < size; --n)
+        {
+            std::int64_t const x = number(gen);
+            switch (t)
+            {
+            case 0: values.emplace_back(x > 0); break;
+            case 1: values.emplace_back(x); break;
+            case 2: values.emplace_back(static_cast<std::uint64_t>(x + 1000)); break;
+            default: values.emplace_back(static_cast<double>(x) / 4); break;
+            }
+        }
+    }
+    return values;
+}
+
+numeric_column to_column(std::vector<numeric_value> const& values)
+{
+    numeric_column column;
+    for (numeric_value const& v : values)
+    {
+        column.push_back(v);
+    }
+    return column;
+}
+
+struct to_double
+{
+    template <typename T>
+    double operator()(T value) const
+    {
+        return static_cast<double>(value);
+    }
+};
+
+} // namespace
+
+TEST_CASE("column_sum promotes like numeric_plus", "[numeric_kernels]")
+{
+    REQUIRE(mapbox::util::column_sum(numeric_column{}) == numeric_value(std::int64_t(0)));
+
+    // Without doubles, the sum is exact and equal to adding up in order.
+    for (int last_type = 0; last_type < 3; ++last_type)
+    {
+        std::vector<numeric_value> const values = make_values(1000, static_cast<unsigned>(last_type), 0, last_type);
+        numeric_value expected{std::int64_t(0)};
+        for (numeric_value const& v : values)
+        {
+            expected = mapbox::util::apply_visitor(mapbox::util::numeric_plus(), expected, v);
+        }
+        numeric_value const sum = mapbox::util::column_sum(to_column(values));
+        REQUIRE(sum.which() == expected.which());
+        REQUIRE(sum == expected);
+    }
+
+    std::vector<numeric_value> const values = make_values(1000, 3, 0, 3);
+    double expected = 0;
+    for (numeric_value const& v : values)
+    {
+        expected += mapbox::util::apply_visitor(to_double(), v);
+    }
+    numeric_column const column = to_column(values);
+    numeric_value const sum = mapbox::util::column_sum(column);
+    REQUIRE(sum.is<double>());
+    REQUIRE(sum.get<double>() == Approx(expected));
+    REQUIRE(mapbox::util::column_mean(column) == Approx(expected / 1000));
+    REQUIRE(std::isnan(mapbox::util::column_mean(numeric_column{})));
+}
+
+TEST_CASE("column_min and column_max compare like numeric_less", "[numeric_kernels]")
+{
+    // Negative int64s and uint64s are not ordered by numeric_less.
+    std::vector<numeric_value> const values = make_values(1000, 4, 2, 3);
+    numeric_column const column = to_column(values);
+    numeric_value const min = mapbox::util::column_min(column);
+    numeric_value const max = mapbox::util::column_max(column);
+    for (numeric_value const& v : values)
+    {
+        REQUIRE_FALSE(mapbox::util::apply_visitor(mapbox::util::numeric_less(), v, min));
+        REQUIRE_FALSE(mapbox::util::apply_visitor(mapbox::util::numeric_less(), max, v));
+    }
+    REQUIRE(min.is<double>());
+    REQUIRE(max.is<std::uint64_t>());
+
+    numeric_column mixed;
+    mixed.push_back(2.0);
+    mixed.push_back(std::int64_t(2));
+    mixed.push_back(true);
+    REQUIRE(mapbox::util::column_min(mixed) == numeric_value(true));
+    REQUIRE(mapbox::util::column_max(mixed) == numeric_value(std::int64_t(2)));
+    REQUIRE_THROWS_AS(mapbox::util::column_min(numeric_column{}), std::invalid_argument&);
+}
+
+TEST_CASE("element wise kernels agree with the scalar visitors", "[numeric_kernels]")
+{
+    std::vector<numeric_value> const lhs = make_values(3000, 5, 0, 3);
+    std::vector<numeric_value> const rhs = make_values(3000, 6, 0, 3);
+    numeric_column const a = to_column(lhs);
+    numeric_column const b = to_column(rhs);
+
+    numeric_column const sum = mapbox::util::column_add(a, b);
+    numeric_column const product = mapbox::util::column_multiply(a, b);
+    mapbox::util::tag_bitmask const less = mapbox::util::column_less(a, b);
+    mapbox::util::tag_bitmask const equal = mapbox::util::column_equal(a, b);
+    REQUIRE(sum.size() == lhs.size());
+    REQUIRE(product.size() == lhs.size());
+
+    for (std::size_t i = 0; i < lhs.size(); ++i)
+    {
+        REQUIRE(numeric_value(sum[i]) == mapbox::util::apply_visitor(mapbox::util::numeric_plus(), lhs[i], rhs[i]));
+        REQUIRE(numeric_value(product[i]) == mapbox::util::apply_visitor(mapbox::util::numeric_multiplies(), lhs[i], rhs[i]));
+        bool const is_less = (less[i / 64] >> (i % 64)) & 1;
+        bool const is_equal = (equal[i / 64] >> (i % 64)) & 1;
+        REQUIRE(is_less == mapbox::util::apply_visitor(mapbox::util::numeric_less(), lhs[i], rhs[i]));
+        REQUIRE(is_equal == mapbox::util::apply_visitor(mapbox::util::numeric_equal_to(), lhs[i], rhs[i]));
+    }
+
+    // Writing into a used column replaces its values.
+    numeric_column reused = product;
+    mapbox::util::column_add(a, b, reused);
+    REQUIRE(reused.tags() == sum.tags());
+    REQUIRE(reused.offsets() == sum.offsets());
+    REQUIRE(numeric_value(reused[lhs.size() - 1]) == numeric_value(sum[lhs.size() - 1]));
+
+    REQUIRE_THROWS_AS(mapbox::util::column_add(a, numeric_column{}), std::invalid_argument&);
+    reused = a;
+    REQUIRE_THROWS_AS(mapbox::util::column_add(reused, b, reused), std::invalid_argument&);
+}
+
+TEST_CASE("numeric visitors promote bools to int64 and wrap integers", "[numeric_kernels]")
+{
+    numeric_value const sum = mapbox::util::apply_visitor(mapbox::util::numeric_plus(), numeric_value(true), numeric_value(true));
+    REQUIRE(sum == numeric_value(std::int64_t(2)));
+    numeric_value const mixed = mapbox::util::apply_visitor(mapbox::util::numeric_plus(), numeric_value(std::int64_t(-1)),
+                                                            numeric_value(std::uint64_t(1)));
+    REQUIRE(mixed == numeric_value(std::uint64_t(0)));
+    numeric_value const wrapped = mapbox::util::apply_visitor(mapbox::util::numeric_plus(),
+                                                              numeric_value(std::numeric_limits<std::int64_t>::max()),
+                                                              numeric_value(std::int64_t(1)));
+    REQUIRE(wrapped == numeric_value(std::numeric_limits<std::int64_t>::min()));
+}
@@ -0,0 +1,146 @@
+#include "catch.hpp"
+
+#include <mapbox/pool_allocator.hpp>
+#include <mapbox/variant.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+template <std::size_t N>
+struct payload
+{
+    int value[N];
+};
+
+struct add;
+
+using expression = mapbox::util::variant<int, mapbox::util::pooled_recursive_wrapper<add>>;
+
+struct add
+{
+    expression left;
+    expression right;
+};
+
+int evaluate(expression const& e)
+{
+    return e.match([](int value) { return value; },
+                   [](add const& a) { return evaluate(a.left) + evaluate(a.right); });
+}
+
+expression make_tree(int depth)
+{
+    if (depth == 0)
+    {
+        return expression{1};
+    }
+    return expression{add{make_tree(depth - 1), make_tree(depth - 1)}};
+}
+
+} // namespace
+
+TEST_CASE("pool_allocator reuses freed nodes", "[pool_allocator]")
+{
+    using allocator = mapbox::util::pool_allocator<payload<1>>;
+    allocator alloc;
+
+    payload<1>* p = alloc.allocate(1);
+    alloc.deallocate(p, 1);
+    payload<1>* q = alloc.allocate(1);
+    REQUIRE(p == q);
+    alloc.deallocate(q, 1);
+
+    mapbox::util::pool_stats const stats = allocator::stats();
+    REQUIRE(stats.allocations == 2);
+    REQUIRE(stats.deallocations == 2);
+    REQUIRE(stats.system_allocations == 1);
+}
+
+TEST_CASE("pool_allocator hands surplus nodes to the global list", "[pool_allocator]")
+{
+    using allocator = mapbox::util::pool_allocator<payload<2>>;
+    allocator alloc;
+
+    std::vector<payload<2>*> nodes;
+    for (int i = 0; i < 1000; ++i)
+    {
+        nodes.push_back(alloc.allocate(1));
+    }
+    for (auto* p : nodes)
+    {
+        alloc.deallocate(p, 1);
+    }
+
+    mapbox::util::pool_stats stats = allocator::stats();
+    REQUIRE(stats.system_allocations == 1000);
+    REQUIRE(stats.spills > 0);
+    REQUIRE(stats.global_free > 0);
+    REQUIRE(stats.global_free <= MAPBOX_VARIANT_POOL_GLOBAL_CAPACITY);
+
+    // another thread takes its nodes from the global list
+    std::thread([&alloc] {
+        alloc.deallocate(alloc.allocate(1), 1);
+    }).join();
+    stats = allocator::stats();
+    REQUIRE(stats.refills == 1);
+    REQUIRE(stats.system_allocations == 1000);
+    REQUIRE(stats.allocations == stats.deallocations);
+
+    allocator::release();
+    stats = allocator::stats();
+    REQUIRE(stats.global_free == 0);
+    REQUIRE(stats.system_deallocations == stats.system_allocations);
+}
+
+TEST_CASE("pool_allocator frees nodes allocated by other threads", "[pool_allocator]")
+{
+    using allocator = mapbox::util::pool_allocator<payload<3>>;
+    allocator alloc;
+
+    std::vector<payload<3>*> nodes;
+    std::thread([&] {
+        for (int i = 0; i < 100; ++i)
+        {
+            nodes.push_back(alloc.allocate(1));
+        }
+    }).join();
+    for (auto* p : nodes)
+    {
+        alloc.deallocate(p, 1);
+    }
+
+    mapbox::util::pool_stats const stats = allocator::stats();
+    REQUIRE(stats.allocations == 100);
+    REQUIRE(stats.deallocations == 100);
+}
+
+TEST_CASE("pooled_recursive_wrapper builds trees from the pool", "[pool_allocator][recursive_wrapper]")
+{
+    using allocator = mapbox::util::pool_allocator<add>;
+    for (int i = 0; i < 2; ++i)
+    {
+        expression const tree = make_tree(5);
+        REQUIRE(evaluate(tree) == 32);
+    }
+
+    mapbox::util::pool_stats const stats = allocator::stats();
+    REQUIRE(stats.allocations == 62);
+    REQUIRE(stats.deallocations == 62);
+    REQUIRE(stats.system_allocations == 31);
+}
+
+TEST_CASE("pool_allocator rejects arrays too large to allocate", "[pool_allocator]")
+{
+    mapbox::util::pool_allocator<payload<4>> alloc;
+    std::size_t const n = std::numeric_limits<std::size_t>::max() / sizeof(payload<4>) + 1;
+    REQUIRE_THROWS_AS(alloc.allocate(n), std::bad_array_new_length&);
+
+    payload<4>* p = alloc.allocate(3);
+    alloc.deallocate(p, 3);
+}
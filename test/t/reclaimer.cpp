@@ -0,0 +1,165 @@
+#include "catch.hpp"
+
+#include <mapbox/reclaimer.hpp>
+#include <mapbox/variant.hpp>
+
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct node;
+
+using tree = mapbox::util::variant<int, mapbox::util::recursive_wrapper<node>>;
+
+struct node
+{
+    std::vector<tree> children;
+};
+
+tree make_tree(int depth)
+{
+    if (depth == 0)
+    {
+        return tree{1};
+    }
+    node n;
+    n.children.push_back(make_tree(depth - 1));
+    n.children.push_back(make_tree(depth - 1));
+    return tree{std::move(n)};
+}
+
+// Records the thread it is destroyed on.
+struct thread_probe
+{
+    std::thread::id* destroyed_on;
+
+    explicit thread_probe(std::thread::id* id)
+        : destroyed_on(id) {}
+
+    thread_probe(thread_probe&& other) noexcept
+        : destroyed_on(other.destroyed_on)
+    {
+        other.destroyed_on = nullptr;
+    }
+
+    ~thread_probe()
+    {
+        if (destroyed_on)
+        {
+            *destroyed_on = std::this_thread::get_id();
+        }
+    }
+};
+
+// Keeps the reclaimer thread busy until released.
+struct blocker
+{
+    std::promise<void>* started;
+    std::shared_future<void> release;
+
+    blocker(std::promise<void>* s, std::shared_future<void> r)
+        : started(s), release(std::move(r)) {}
+
+    blocker(blocker&& other) noexcept
+        : started(other.started), release(std::move(other.release))
+    {
+        other.started = nullptr;
+    }
+
+    ~blocker()
+    {
+        if (started)
+        {
+            started->set_value();
+            release.wait();
+        }
+    }
+};
+
+} // namespace
+
+TEST_CASE("reclaimer destroys values on its own thread", "[reclaimer]")
+{
+    std::thread::id destroyed_on;
+    mapbox::util::reclaimer reclaimer;
+
+    tree t = make_tree(10);
+    reclaimer.retire(std::move(t));
+    reclaimer.retire(thread_probe{&destroyed_on});
+    reclaimer.flush();
+
+    REQUIRE(t.get_unchecked<mapbox::util::recursive_wrapper<node>>().get_pointer() == nullptr);
+    REQUIRE(destroyed_on != std::thread::id());
+    REQUIRE(destroyed_on != std::this_thread::get_id());
+
+    mapbox::util::reclaimer_stats const stats = reclaimer.stats();
+    REQUIRE(stats.retired == 2);
+    REQUIRE(stats.reclaimed == 2);
+    REQUIRE(stats.destroyed_inline == 0);
+    REQUIRE(stats.pending == 0);
+}
+
+TEST_CASE("reclaimer destroys values inline when its queue is full", "[reclaimer]")
+{
+    mapbox::util::reclaimer_options options;
+    options.max_pending = 2;
+    options.batch_size = 1;
+    mapbox::util::reclaimer reclaimer(options);
+
+    std::promise<void> started;
+    std::promise<void> release;
+    reclaimer.retire(blocker{&started, release.get_future().share()});
+    started.get_future().wait();
+
+    reclaimer.retire(make_tree(3));
+    reclaimer.retire(make_tree(3));
+    std::thread::id destroyed_on;
+    reclaimer.retire(thread_probe{&destroyed_on});
+    REQUIRE(destroyed_on == std::this_thread::get_id());
+    REQUIRE(reclaimer.stats().pending == 2);
+
+    release.set_value();
+    reclaimer.flush();
+    mapbox::util::reclaimer_stats const stats = reclaimer.stats();
+    REQUIRE(stats.retired == 3);
+    REQUIRE(stats.reclaimed == 3);
+    REQUIRE(stats.destroyed_inline == 1);
+    REQUIRE(stats.batches == 3);
+}
+
+TEST_CASE("reclaimer can make retire wait for room", "[reclaimer]")
+{
+    mapbox::util::reclaimer_options options;
+    options.max_pending = 1;
+    options.overflow = mapbox::util::reclaimer_overflow::wait;
+    mapbox::util::reclaimer reclaimer(options);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        reclaimer.retire(make_tree(4));
+    }
+    reclaimer.flush();
+    mapbox::util::reclaimer_stats const stats = reclaimer.stats();
+    REQUIRE(stats.retired == 100);
+    REQUIRE(stats.reclaimed == 100);
+    REQUIRE(stats.destroyed_inline == 0);
+}
+
+TEST_CASE("reclaimer rejects an empty batch size", "[reclaimer]")
+{
+    mapbox::util::reclaimer_options options;
+    options.batch_size = 0;
+    REQUIRE_THROWS_AS(mapbox::util::reclaimer(options), std::invalid_argument&);
+}
+
+TEST_CASE("reclaimer rejects an empty queue", "[reclaimer]")
+{
+    mapbox::util::reclaimer_options options;
+    options.max_pending = 0;
+    options.overflow = mapbox::util::reclaimer_overflow::wait;
+    REQUIRE_THROWS_AS(mapbox::util::reclaimer(options), std::invalid_argument&);
+}
@@ -5,6 +5,7 @@
 
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 using rwi = mapbox::util::recursive_wrapper<int>;
 using rwp = mapbox::util::recursive_wrapper<std::pair<int, int>>;
@@ -96,6 +97,240 @@ TEST_CASE("move of recursive wrapper")
     }
 }
 
+TEST_CASE("move of recursive wrapper does not allocate")
+{
+    static_assert(std::is_nothrow_move_constructible<rwi>::value, "recursive_wrapper must be nothrow move constructible");
+    static_assert(std::is_nothrow_move_constructible<mapbox::util::variant<int, rwp>>::value,
+                  "variant of recursive_wrapper must be nothrow move constructible");
+    static_assert(std::is_nothrow_move_assignable<mapbox::util::variant<int, rwp>>::value,
+                  "variant of recursive_wrapper must be nothrow move assignable");
+
+    rwi a{1};
+    int const* p = a.get_pointer();
+
+    rwi b{std::move(a)};
+    REQUIRE(b.get_pointer() == p);
+    REQUIRE(a.get_pointer() == nullptr);
+
+    SECTION("copy of moved-from wrapper is empty")
+    {
+        rwi c{a};
+        REQUIRE(c.get_pointer() == nullptr);
+
+        b = c;
+        REQUIRE(b.get_pointer() == nullptr);
+    }
+
+    SECTION("moved-from wrapper can be assigned to")
+    {
+        a = 2;
+        REQUIRE(a.get() == 2);
+
+        rwi c{std::move(a)};
+        a = c;
+        REQUIRE(a.get() == 2);
+        REQUIRE(a.get_pointer() != c.get_pointer());
+    }
+}
+
+TEST_CASE("vector of recursive variants moves its elements on growth")
+{
+    using variant_type = mapbox::util::variant<int, rwp>;
+    std::vector<variant_type> values;
+    values.emplace_back(std::make_pair(1, 2));
+    rwp::type const* p = &values.front().get<rwp::type>();
+
+    for (int i = 0; i < 100; ++i)
+    {
+        values.emplace_back(i);
+    }
+    REQUIRE(&values.front().get<rwp::type>() == p);
+}
+
+namespace {
+
+struct counted_default
+{
+    static int constructed;
+
+    int value;
+
+    counted_default() : value(42) { ++constructed; }
+    counted_default(int v) : value(v) {}
+};
+
+int counted_default::constructed = 0;
+
+} // namespace
+
+// Default constructed wrappers of counted_default start out empty.
+namespace mapbox {
+namespace util {
+
+template <>
+struct deferred_allocation<counted_default> : std::true_type
+{
+};
+
+} // namespace util
+} // namespace mapbox
+
+TEST_CASE("default constructed recursive wrapper allocates")
+{
+    rwp a;
+    REQUIRE(a.get_pointer() != nullptr);
+
+    rwp const b{a};
+    REQUIRE(b.get_pointer() != nullptr);
+    REQUIRE(b.get_pointer() != a.get_pointer());
+
+    using variant_type = mapbox::util::variant<rwp, int>;
+    variant_type const v;
+    REQUIRE(v.get_unchecked<rwp>().get_pointer() != nullptr);
+}
+
+TEST_CASE("default constructed recursive wrapper with deferred allocation does not allocate")
+{
+    using rwc = mapbox::util::recursive_wrapper<counted_default>;
+    counted_default::constructed = 0;
+
+    rwc a;
+    REQUIRE(a.get_pointer() == nullptr);
+
+    SECTION("const access sees a default value")
+    {
+        rwc const& c = a;
+        REQUIRE(c.get().value == 42);
+        REQUIRE(a.get_pointer() == nullptr);
+
+        rwc b{a};
+        REQUIRE(b.get_pointer() == nullptr);
+        REQUIRE(counted_default::constructed <= 1);
+    }
+
+    SECTION("non-const access allocates")
+    {
+        a.get().value = 1;
+        REQUIRE(a.get_pointer() != nullptr);
+        REQUIRE(a.get().value == 1);
+    }
+
+    SECTION("assignment allocates")
+    {
+        a = counted_default{2};
+        REQUIRE(a.get_pointer() != nullptr);
+        REQUIRE(a.get().value == 2);
+    }
+}
+
+TEST_CASE("default constructed variant with deferred allocation does not allocate")
+{
+    using rwc = mapbox::util::recursive_wrapper<counted_default>;
+    using variant_type = mapbox::util::variant<rwc, int>;
+    variant_type const v;
+    REQUIRE(v.get<counted_default>().value == 42);
+    REQUIRE(v.get_unchecked<rwc>().get_pointer() == nullptr);
+
+    variant_type const w{v};
+    REQUIRE(w.get_unchecked<rwc>().get_pointer() == nullptr);
+}
+
+namespace {
+
+struct counted_node;
+
+} // namespace
+
+// Deep trees of counted_nodes are destroyed with a bounded stack.
+namespace mapbox {
+namespace util {
+
+template <>
+struct bounded_teardown<counted_node> : std::true_type
+{
+};
+
+} // namespace util
+} // namespace mapbox
+
+namespace {
+
+using counted_tree = mapbox::util::variant<int, mapbox::util::recursive_wrapper<counted_node>>;
+
+struct counted_node
+{
+    static int destroyed;
+
+    std::vector<counted_tree> children;
+
+    counted_node() = default;
+    counted_node(counted_node const&) = default;
+    counted_node(counted_node&&) = default;
+    counted_node& operator=(counted_node const&) = default;
+    counted_node& operator=(counted_node&&) = default;
+    ~counted_node() { ++destroyed; }
+};
+
+int counted_node::destroyed = 0;
+
+} // namespace
+
+TEST_CASE("destroying deep trees does not recurse")
+{
+    static_assert(!mapbox::util::bounded_teardown<std::pair<int, int>>::value, "bounded teardown must be opt-in");
+
+    counted_node::destroyed = 0;
+
+    SECTION("long chain")
+    {
+        {
+            counted_tree head{0};
+            for (int i = 0; i < 1000000; ++i)
+            {
+                counted_node n;
+                n.children.push_back(std::move(head));
+                head = std::move(n);
+            }
+            counted_node::destroyed = 0;
+        }
+        REQUIRE(counted_node::destroyed == 1000000);
+    }
+
+    SECTION("long chain of wide nodes")
+    {
+        {
+            counted_tree head{0};
+            for (int i = 0; i < 1000; ++i)
+            {
+                counted_node n;
+                n.children.push_back(std::move(head));
+                for (int j = 0; j < 20; ++j)
+                {
+                    n.children.emplace_back(counted_node());
+                }
+                head = std::move(n);
+            }
+            counted_node::destroyed = 0;
+        }
+        REQUIRE(counted_node::destroyed == 21000);
+    }
+
+    SECTION("wide tree")
+    {
+        {
+            counted_node root;
+            for (int i = 0; i < 100; ++i)
+            {
+                counted_node child;
+                child.children.emplace_back(counted_node());
+                root.children.emplace_back(std::move(child));
+            }
+            counted_node::destroyed = 0;
+        }
+        REQUIRE(counted_node::destroyed == 201);
+    }
+}
+
 TEST_CASE("swap")
 {
     rwi a{1};
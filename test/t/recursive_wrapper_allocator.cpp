@@ -0,0 +1,275 @@
+#include "catch.hpp"
+
+#include <mapbox/variant.hpp>
+#include <mapbox/recursive_wrapper.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define HAS_MEMORY_RESOURCE
+#endif
+#endif
+
+namespace {
+
+// Hands out memory from a list of blocks and frees it all at once.
+struct arena
+{
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::size_t allocated = 0;
+    std::size_t deallocated = 0;
+
+    void* allocate(std::size_t size)
+    {
+        ++allocated;
+        blocks.emplace_back(new char[size]);
+        return blocks.back().get();
+    }
+
+    void deallocate(void*)
+    {
+        ++deallocated;
+    }
+};
+
+template <typename T>
+struct arena_allocator
+{
+    using value_type = T;
+
+    arena* a;
+
+    arena_allocator() : a(nullptr) {}
+    explicit arena_allocator(arena& a_) : a(&a_) {}
+
+    template <typename U>
+    arena_allocator(arena_allocator<U> const& other) : a(other.a) {}
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(a ? a->allocate(n * sizeof(T)) : ::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t)
+    {
+        if (a)
+        {
+            a->deallocate(p);
+        }
+        else
+        {
+            ::operator delete(p);
+        }
+    }
+};
+
+template <typename T, typename U>
+bool operator==(arena_allocator<T> const& lhs, arena_allocator<U> const& rhs)
+{
+    return lhs.a == rhs.a;
+}
+
+template <typename T, typename U>
+bool operator!=(arena_allocator<T> const& lhs, arena_allocator<U> const& rhs)
+{
+    return lhs.a != rhs.a;
+}
+
+// Like arena_allocator, but copy assignment hands over the arena.
+template <typename T>
+struct propagating_allocator : arena_allocator<T>
+{
+    using propagate_on_container_copy_assignment = std::true_type;
+
+    propagating_allocator() = default;
+    explicit propagating_allocator(arena& a_) : arena_allocator<T>(a_) {}
+
+    template <typename U>
+    propagating_allocator(propagating_allocator<U> const& other) : arena_allocator<T>(other) {}
+};
+
+struct add;
+
+using wrapped_add = mapbox::util::recursive_wrapper<add, arena_allocator<add>>;
+using expression = mapbox::util::variant<int, wrapped_add>;
+
+struct add
+{
+    expression left;
+    expression right;
+};
+
+struct calculator
+{
+    int operator()(int value) const
+    {
+        return value;
+    }
+
+    int operator()(add const& a) const
+    {
+        return mapbox::util::apply_visitor(*this, a.left) + mapbox::util::apply_visitor(*this, a.right);
+    }
+};
+
+expression make_tree(arena& a, int depth)
+{
+    if (depth == 0)
+    {
+        return expression{1};
+    }
+    return expression{wrapped_add{std::allocator_arg, arena_allocator<add>{a},
+                                  add{make_tree(a, depth - 1), make_tree(a, depth - 1)}}};
+}
+
+} // namespace
+
+TEST_CASE("recursive_wrapper with a stateless allocator takes no extra space", "[recursive_wrapper][allocator]")
+{
+    REQUIRE(sizeof(mapbox::util::recursive_wrapper<int>) == sizeof(int*));
+    REQUIRE(sizeof(wrapped_add) == sizeof(arena_allocator<add>) + sizeof(add*));
+}
+
+TEST_CASE("recursive_wrapper allocates with its allocator", "[recursive_wrapper][allocator]")
+{
+    arena a;
+    {
+        expression const tree = make_tree(a, 4);
+        REQUIRE(a.allocated == 15);
+        REQUIRE(mapbox::util::apply_visitor(calculator(), tree) == 16);
+
+        REQUIRE(tree.is<add>());
+        REQUIRE(tree.get<add>().left.is<add>());
+        REQUIRE(tree.get_unchecked<wrapped_add>().get_allocator().a == &a);
+    }
+    REQUIRE(a.deallocated == 15);
+}
+
+TEST_CASE("copies of recursive_wrapper use the same allocator", "[recursive_wrapper][allocator]")
+{
+    arena a;
+    expression const tree = make_tree(a, 2);
+    expression const copy{tree};
+    REQUIRE(a.allocated == 6);
+    REQUIRE(copy.get_unchecked<wrapped_add>().get_allocator().a == &a);
+    REQUIRE(mapbox::util::apply_visitor(calculator(), copy) == 4);
+}
+
+TEST_CASE("moving between recursive_wrappers with different allocators", "[recursive_wrapper][allocator]")
+{
+    arena a;
+    arena b;
+    wrapped_add x{std::allocator_arg, arena_allocator<add>{a}, add{expression{1}, expression{2}}};
+    wrapped_add y{std::allocator_arg, arena_allocator<add>{b}, add{expression{3}, expression{4}}};
+    add const* p = y.get_pointer();
+
+    SECTION("move assignment keeps the value in the allocator of the target")
+    {
+        x = std::move(y);
+        REQUIRE(x.get_allocator().a == &a);
+        REQUIRE(x.get().left.get<int>() == 3);
+        REQUIRE(a.allocated == 1);
+        REQUIRE(b.allocated == 1);
+    }
+
+    SECTION("move construction takes over the value and the allocator")
+    {
+        wrapped_add z{std::move(y)};
+        REQUIRE(z.get_allocator().a == &b);
+        REQUIRE(z.get_pointer() == p);
+    }
+
+    SECTION("move assignment with equal allocators takes over the value")
+    {
+        wrapped_add z{std::allocator_arg, arena_allocator<add>{b}};
+        z = std::move(y);
+        REQUIRE(z.get_pointer() == p);
+        REQUIRE(b.allocated == 2);
+    }
+}
+
+TEST_CASE("copying between recursive_wrappers with different allocators", "[recursive_wrapper][allocator]")
+{
+    arena a;
+    arena b;
+
+    SECTION("copy assignment keeps the allocator of the target")
+    {
+        using wrapper = mapbox::util::recursive_wrapper<int, arena_allocator<int>>;
+        wrapper x{std::allocator_arg, arena_allocator<int>{a}, 1};
+        wrapper const y{std::allocator_arg, arena_allocator<int>{b}, 2};
+        x = y;
+        REQUIRE(x.get() == 2);
+        REQUIRE(x.get_allocator().a == &a);
+        REQUIRE(a.allocated == 1);
+        REQUIRE(a.deallocated == 0);
+        REQUIRE(b.allocated == 1);
+    }
+
+    SECTION("copy assignment takes over an allocator that propagates")
+    {
+        using wrapper = mapbox::util::recursive_wrapper<int, propagating_allocator<int>>;
+        wrapper x{std::allocator_arg, propagating_allocator<int>{a}, 1};
+        wrapper const y{std::allocator_arg, propagating_allocator<int>{b}, 2};
+        x = y;
+        REQUIRE(x.get() == 2);
+        REQUIRE(x.get_allocator().a == &b);
+        REQUIRE(a.allocated == 1);
+        REQUIRE(a.deallocated == 1);
+        REQUIRE(b.allocated == 2);
+    }
+
+    SECTION("copy assignment with equal allocators that propagate reuses the value")
+    {
+        using wrapper = mapbox::util::recursive_wrapper<int, propagating_allocator<int>>;
+        wrapper x{std::allocator_arg, propagating_allocator<int>{b}, 1};
+        wrapper const y{std::allocator_arg, propagating_allocator<int>{b}, 2};
+        int const* p = x.get_pointer();
+        x = y;
+        REQUIRE(x.get() == 2);
+        REQUIRE(x.get_pointer() == p);
+        REQUIRE(b.allocated == 2);
+        REQUIRE(b.deallocated == 0);
+    }
+}
+
+#ifdef HAS_MEMORY_RESOURCE
+namespace {
+
+struct pmr_node;
+
+using pmr_tree = mapbox::util::variant<int, mapbox::util::recursive_wrapper<pmr_node, std::pmr::polymorphic_allocator<pmr_node>>>;
+
+struct pmr_node
+{
+    pmr_tree child;
+};
+
+} // namespace
+
+TEST_CASE("recursive_wrapper works with std::pmr", "[recursive_wrapper][allocator]")
+{
+    using wrapper = mapbox::util::recursive_wrapper<pmr_node, std::pmr::polymorphic_allocator<pmr_node>>;
+
+    std::pmr::monotonic_buffer_resource resource;
+    pmr_tree tree{1};
+    for (int i = 0; i < 100; ++i)
+    {
+        tree = pmr_tree{wrapper{std::allocator_arg, &resource, pmr_node{std::move(tree)}}};
+    }
+
+    int depth = 0;
+    for (pmr_tree const* t = &tree; t->is<pmr_node>(); t = &t->get<pmr_node>().child)
+    {
+        REQUIRE(t->get_unchecked<wrapper>().get_allocator().resource() == &resource);
+        ++depth;
+    }
+    REQUIRE(depth == 100);
+}
+#endif
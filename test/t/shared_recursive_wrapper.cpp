@@ -0,0 +1,221 @@
+#include "catch.hpp"
+
+#include <mapbox/variant.hpp>
+#include <mapbox/shared_recursive_wrapper.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct node;
+
+using tree = mapbox::util::variant<int, std::string, mapbox::util::shared_recursive_wrapper<node>>;
+
+struct node
+{
+    std::vector<tree> children;
+
+    bool operator==(node const& rhs) const
+    {
+        return children == rhs.children;
+    }
+};
+
+struct counting_equal
+{
+    static int compared;
+
+    int value;
+
+    bool operator==(counting_equal const& rhs) const
+    {
+        ++compared;
+        return value == rhs.value;
+    }
+};
+
+int counting_equal::compared = 0;
+
+struct append_child
+{
+    template <typename T>
+    void operator()(T&) const
+    {
+    }
+
+    void operator()(node& n) const
+    {
+        n.children.emplace_back(3);
+    }
+};
+
+struct node_address
+{
+    template <typename T>
+    node const* operator()(T const&) const
+    {
+        return nullptr;
+    }
+
+    node const* operator()(node const& n) const
+    {
+        return &n;
+    }
+};
+
+} // namespace
+
+using srw = mapbox::util::shared_recursive_wrapper<std::string>;
+
+TEST_CASE("shared_recursive_wrapper shares its value on copy", "[shared_recursive_wrapper]")
+{
+    srw a{std::string("value")};
+    srw const b{a};
+    REQUIRE(a.use_count() == 2);
+    REQUIRE(static_cast<srw const&>(a).get_pointer() == b.get_pointer());
+
+    SECTION("const access does not copy")
+    {
+        srw const& c = a;
+        REQUIRE(c.get() == "value");
+        REQUIRE(a.use_count() == 2);
+    }
+
+    SECTION("mutable access copies a shared value")
+    {
+        a.get() += "!";
+        REQUIRE(a.get() == "value!");
+        REQUIRE(b.get() == "value");
+        REQUIRE(a.use_count() == 1);
+        REQUIRE(b.use_count() == 1);
+
+        std::string const* p = a.get_pointer();
+        a.get() += "!";
+        REQUIRE(a.get_pointer() == p);
+    }
+
+    SECTION("mutable access after a copy does not modify the copy")
+    {
+        a.get() += "!";
+        srw const c{a};
+        REQUIRE(a.use_count() == 2);
+
+        a.get() += "?";
+        REQUIRE(a.get() == "value!?");
+        REQUIRE(c.get() == "value!");
+        REQUIRE(b.get() == "value");
+    }
+
+    SECTION("assignment does not modify a shared value")
+    {
+        a = std::string("other");
+        REQUIRE(a.get() == "other");
+        REQUIRE(b.get() == "value");
+    }
+}
+
+TEST_CASE("empty shared_recursive_wrapper", "[shared_recursive_wrapper]")
+{
+    srw a;
+    REQUIRE(a.use_count() == 0);
+    REQUIRE(static_cast<srw const&>(a).get().empty());
+    REQUIRE(static_cast<srw const&>(a).get_pointer() == nullptr);
+
+    srw b{std::string("value")};
+    srw c{std::move(b)};
+    REQUIRE(b.use_count() == 0);
+    REQUIRE(c.use_count() == 1);
+
+    a.get() = "set";
+    REQUIRE(a.get() == "set");
+    REQUIRE(a.use_count() == 1);
+}
+
+TEST_CASE("variant copies share shared_recursive_wrapper nodes", "[shared_recursive_wrapper]")
+{
+    static_assert(std::is_nothrow_move_constructible<tree>::value, "tree must be nothrow move constructible");
+
+    tree original{node{{tree{1}, tree{std::string("two")}, tree{node{{tree{3}}}}}}};
+    tree copy{original};
+
+    REQUIRE(copy.is<node>());
+    REQUIRE(original.get_unchecked<mapbox::util::shared_recursive_wrapper<node>>().use_count() == 2);
+
+    tree const& const_copy = copy;
+    REQUIRE(&const_copy.get<node>() == &static_cast<tree const&>(original).get<node>());
+    REQUIRE(copy == original);
+
+    copy.get<node>().children.emplace_back(4);
+    REQUIRE(copy.get<node>().children.size() == 4);
+    REQUIRE(static_cast<tree const&>(original).get<node>().children.size() == 3);
+    REQUIRE_FALSE(copy == original);
+}
+
+TEST_CASE("visiting a const variant does not copy a shared node", "[shared_recursive_wrapper]")
+{
+    tree const original{node{{tree{1}, tree{2}}}};
+    tree const copy{original};
+    auto const& wrapper = original.get_unchecked<mapbox::util::shared_recursive_wrapper<node>>();
+
+    std::size_t size = copy.match([](int) { return std::size_t(0); },
+                                  [](std::string const&) { return std::size_t(0); },
+                                  [](node const& n) { return n.children.size(); });
+    REQUIRE(size == 2);
+    REQUIRE(wrapper.use_count() == 2);
+
+    REQUIRE(mapbox::util::apply_visitor(node_address(), copy) == &wrapper.get());
+    REQUIRE(wrapper.use_count() == 2);
+}
+
+TEST_CASE("mutating visitor copies a shared node", "[shared_recursive_wrapper]")
+{
+    tree const original{node{{tree{1}, tree{2}}}};
+    tree copy{original};
+
+    mapbox::util::apply_visitor(append_child(), copy);
+    REQUIRE(copy.get<node>().children.size() == 3);
+    REQUIRE(original.get<node>().children.size() == 2);
+    REQUIRE(original.get_unchecked<mapbox::util::shared_recursive_wrapper<node>>().use_count() == 1);
+}
+
+TEST_CASE("comparing variants sharing a node does not compare the values", "[shared_recursive_wrapper]")
+{
+    using variant_type = mapbox::util::variant<int, mapbox::util::shared_recursive_wrapper<counting_equal>>;
+    variant_type const a{counting_equal{1}};
+    variant_type const b{a};
+    variant_type const c{counting_equal{1}};
+
+    counting_equal::compared = 0;
+    REQUIRE(a == b);
+    REQUIRE(counting_equal::compared == 0);
+    REQUIRE(a == c);
+    REQUIRE(counting_equal::compared == 1);
+}
+
+TEST_CASE("shared_recursive_wrapper can be released on several threads", "[shared_recursive_wrapper]")
+{
+    tree const original{node{{tree{1}, tree{2}}}};
+    std::atomic<int> copies{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([original, &copies] {
+            for (int j = 0; j < 1000; ++j)
+            {
+                tree copy{original};
+                copies += copy.is<node>() ? 1 : 0;
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    REQUIRE(copies == 4000);
+    REQUIRE(original.get_unchecked<mapbox::util::shared_recursive_wrapper<node>>().use_count() == 1);
+}
@@ -14,11 +14,16 @@ struct some_struct
     std::string c;
 };
 
-using variant_internal_index_type = mapbox::util::type_index_t;
+// five bytes, but aligned like an int when stored next to one
+struct five_bytes
+{
+    char c[5];
+};
 
 TEST_CASE("size of variants")
 {
-    constexpr const auto min_overhead = sizeof(variant_internal_index_type);
+    // variants with fewer than 255 alternatives use a one byte index
+    constexpr const auto min_overhead = sizeof(std::uint8_t);
 
     using namespace std; // workaround for bug in GCC <= 4.8 where max_align_t is not in std
     constexpr const auto max_overhead = alignof(max_align_t) + min_overhead;
@@ -49,3 +54,15 @@ TEST_CASE("size of variants")
     REQUIRE(sizeof(v4) >= min_overhead + sstr);
     REQUIRE(sizeof(v5) >= min_overhead + ss);
 }
+
+TEST_CASE("variant index uses the smallest type and the tail padding")
+{
+    REQUIRE(sizeof(mapbox::util::variant<char>) == 2);
+    REQUIRE(sizeof(mapbox::util::variant<char, bool>) == 2);
+    REQUIRE(sizeof(mapbox::util::variant<std::int16_t>) == 2 * sizeof(std::int16_t));
+    REQUIRE(sizeof(mapbox::util::variant<int>) == 2 * sizeof(int));
+    REQUIRE(sizeof(mapbox::util::variant<double, std::int64_t>) == 2 * sizeof(double));
+
+    // the index goes into the three padding bytes after the five byte value
+    REQUIRE(sizeof(mapbox::util::variant<int, five_bytes>) == 2 * sizeof(int));
+}
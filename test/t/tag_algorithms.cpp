@@ -0,0 +1,139 @@
+#include "catch.hpp"
+
+#include <mapbox/tag_algorithms.hpp>
+#include <mapbox/variant.hpp>
+#include <mapbox/variant_vector.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using variant_type = mapbox::util::variant<int, double, std::string>;
+using vector_type = mapbox::util::variant_vector<int, double, std::string>;
+
+std::vector<variant_type> make_values(std::size_t size, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> type(0, 2);
+    std::vector<variant_type> values;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        switch (type(gen))
+        {
+        case 0: values.emplace_back(static_cast<int>(i)); break;
+        case 1: values.emplace_back(0.5); break;
+        default: values.emplace_back(std::string("s")); break;
+        }
+    }
+    return values;
+}
+
+std::vector<std::uint32_t> expected_partition(std::vector<variant_type> const& values, int which)
+{
+    std::vector<std::uint32_t> positions;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            if ((values[i].which() == which) == (pass == 0))
+            {
+                positions.push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+    }
+    return positions;
+}
+
+} // namespace
+
+TEST_CASE("tag algorithms agree with a loop over which()", "[tag_algorithms]")
+{
+    // Sizes around the 64 tags compared at a time and the gathered blocks.
+    std::vector<std::size_t> const sizes = {0, 1, 63, 64, 65, 130, 4095, 4096, 4097, 9000};
+    for (std::size_t size : sizes)
+    {
+        std::vector<variant_type> const values = make_values(size, static_cast<unsigned>(size));
+        vector_type column;
+        for (variant_type const& v : values)
+        {
+            column.push_back(v);
+        }
+
+        std::size_t doubles = 0;
+        std::size_t first_double = size;
+        mapbox::util::tag_bitmask mask((size + 63) / 64);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            if (values[i].is<double>())
+            {
+                ++doubles;
+                first_double = std::min(first_double, i);
+                mask[i / 64] |= std::uint64_t(1) << (i % 64);
+            }
+        }
+
+        REQUIRE(mapbox::util::count_alternative<double>(column) == doubles);
+        REQUIRE(mapbox::util::count_alternative<double>(values) == doubles);
+        REQUIRE(mapbox::util::find_alternative<double>(column) == first_double);
+        REQUIRE(mapbox::util::find_alternative<double>(values) == first_double);
+        REQUIRE(mapbox::util::alternative_mask<double>(column) == mask);
+        REQUIRE(mapbox::util::alternative_mask<double>(values) == mask);
+
+        std::vector<std::uint32_t> const partition = expected_partition(values, 1);
+        REQUIRE(mapbox::util::stable_partition_alternative<double>(column) == partition);
+        REQUIRE(mapbox::util::stable_partition_alternative<double>(values) == partition);
+    }
+}
+
+TEST_CASE("tag algorithms find tags in the last positions", "[tag_algorithms]")
+{
+    std::vector<std::uint8_t> tags(200, 0);
+    REQUIRE(mapbox::util::find_tag(tags.data(), tags.size(), 1) == tags.size());
+    tags[199] = 1;
+    REQUIRE(mapbox::util::find_tag(tags.data(), tags.size(), 1) == 199);
+    tags[64] = 1;
+    REQUIRE(mapbox::util::find_tag(tags.data(), tags.size(), 1) == 64);
+    REQUIRE(mapbox::util::count_tag(tags.data(), tags.size(), 1) == 2);
+    REQUIRE(mapbox::util::count_tag(tags.data(), tags.size(), 0) == 198);
+}
+
+TEST_CASE("group_by_alternative orders positions by type", "[tag_algorithms]")
+{
+    std::vector<variant_type> const values = {variant_type{std::string("a")}, variant_type{1}, variant_type{2.0},
+                                              variant_type{3}, variant_type{std::string("b")}};
+    REQUIRE((mapbox::util::group_by_alternative(values) == std::vector<std::uint32_t>{1, 3, 2, 0, 4}));
+
+    std::vector<variant_type> const many = make_values(10000, 7);
+    std::vector<std::uint32_t> expected;
+    for (int which = 0; which < 3; ++which)
+    {
+        for (std::size_t i = 0; i < many.size(); ++i)
+        {
+            if (many[i].which() == which)
+            {
+                expected.push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+    }
+    REQUIRE(mapbox::util::group_by_alternative(many) == expected);
+}
+
+TEST_CASE("permutations reject columns with positions beyond 32 bits", "[tag_algorithms]")
+{
+    if (std::numeric_limits<std::size_t>::max() <= std::numeric_limits<std::uint32_t>::max())
+    {
+        return;
+    }
+    // The size is checked before any tag is read.
+    std::uint8_t const tags[1] = {0};
+    std::size_t const size = std::size_t(std::numeric_limits<std::uint32_t>::max()) + 1;
+    REQUIRE_THROWS_AS(mapbox::util::stable_partition_tag(tags, size, 0), std::length_error&);
+    REQUIRE_THROWS_AS(mapbox::util::group_by_tag(tags, size), std::length_error&);
+}
@@ -0,0 +1,45 @@
+// Built with the plain loops and linked with tag_algorithms.cpp, which uses
+// the instruction set the compiler targets. Each translation unit must get
+// its own kernels.
+#define MAPBOX_VARIANT_NO_SIMD
+
+#include "catch.hpp"
+
+#include <mapbox/numeric_kernels.hpp>
+#include <mapbox/tag_algorithms.hpp>
+#include <mapbox/variant_vector.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+TEST_CASE("tag queries with plain loops link next to the vectorized ones", "[tag_algorithms]")
+{
+    REQUIRE(std::string(mapbox::util::tag_simd_instruction_set()) == "scalar");
+
+    std::vector<std::uint8_t> tags(200, 0);
+    tags[70] = 1;
+    tags[130] = 1;
+    REQUIRE(mapbox::util::count_tag(tags.data(), tags.size(), 1) == 2);
+    REQUIRE(mapbox::util::find_tag(tags.data(), tags.size(), 1) == 70);
+
+    mapbox::util::variant_vector<int, double> values;
+    for (std::size_t i = 0; i < 100; ++i)
+    {
+        values.push_back(i % 3 == 0 ? 0.5 : 1.0);
+    }
+    REQUIRE(mapbox::util::count_alternative<double>(values) == 100);
+
+    mapbox::util::numeric_column a;
+    mapbox::util::numeric_column b;
+    for (std::int64_t i = 0; i < 100; ++i)
+    {
+        a.push_back(i);
+        b.push_back(static_cast<double>(i % 2));
+    }
+    mapbox::util::tag_bitmask const less = mapbox::util::column_less(b, a);
+    REQUIRE(less.size() == 2);
+    REQUIRE((less[0] & 0x3) == 0x0);
+    REQUIRE((less[0] & 0xc) == 0xc);
+}
@@ -125,3 +125,88 @@ TEST_CASE("changes in const visitor (with mutable internals) should be visible",
     REQUIRE(mapbox::util::apply_visitor(ts, v) == sizeof(std::string));
     REQUIRE(ts.result() == sizeof(std::string));
 }
+
+template <int N>
+struct tag
+{
+};
+
+struct tag_value
+{
+    template <int N>
+    int operator()(tag<N> const&) const
+    {
+        return N;
+    }
+};
+
+struct tag_increment
+{
+    template <int N>
+    void operator()(tag<N>&) const
+    {
+    }
+
+    void operator()(int& val) const
+    {
+        ++val;
+    }
+};
+
+TEST_CASE("visitor works on variants dispatched through a jump table", "[visitor][unary visitor]")
+{
+    using variant_type = mapbox::util::variant<tag<0>, tag<1>, tag<2>, tag<3>, tag<4>, tag<5>, tag<6>, tag<7>,
+                                               tag<8>, tag<9>, tag<10>, tag<11>, tag<12>, tag<13>, tag<14>, tag<15>,
+                                               tag<16>>;
+    static_assert(std::tuple_size<variant_type::types>::value > MAPBOX_VARIANT_DISPATCH_TABLE_THRESHOLD,
+                  "variant must be large enough to use table dispatch");
+
+    REQUIRE(mapbox::util::apply_visitor(tag_value{}, variant_type{tag<0>{}}) == 0);
+    REQUIRE(mapbox::util::apply_visitor(tag_value{}, variant_type{tag<7>{}}) == 7);
+    REQUIRE(mapbox::util::apply_visitor(tag_value{}, variant_type{tag<16>{}}) == 16);
+
+    const variant_type v{tag<5>{}};
+    REQUIRE(mapbox::util::apply_visitor(tag_value{}, v) == 5);
+    REQUIRE(v.match(tag_value{}) == 5);
+}
+
+TEST_CASE("visitor works on variants of eight alternatives", "[visitor][unary visitor]")
+{
+    using variant_type = mapbox::util::variant<tag<0>, tag<1>, tag<2>, tag<3>, tag<4>, tag<5>, tag<6>, tag<7>>;
+
+    REQUIRE(mapbox::util::apply_visitor(tag_value{}, variant_type{tag<0>{}}) == 0);
+    REQUIRE(mapbox::util::apply_visitor(tag_value{}, variant_type{tag<3>{}}) == 3);
+    REQUIRE(mapbox::util::apply_visitor(tag_value{}, variant_type{tag<7>{}}) == 7);
+
+    const variant_type v{tag<5>{}};
+    REQUIRE(v.match([](tag<5> const&) { return 1; },
+                    [](tag<7> const&) { return 2; },
+                    [](tag<0> const&) { return 3; },
+                    [](tag<1> const&) { return 3; },
+                    [](tag<2> const&) { return 3; },
+                    [](tag<3> const&) { return 3; },
+                    [](tag<4> const&) { return 3; },
+                    [](tag<6> const&) { return 3; }) == 1);
+}
+
+TEST_CASE("mutating visitor works on variants dispatched through a jump table", "[visitor][unary visitor]")
+{
+    using variant_type = mapbox::util::variant<tag<0>, tag<1>, tag<2>, tag<3>, tag<4>, tag<5>, int, tag<7>,
+                                               tag<8>, tag<9>, tag<10>, tag<11>, tag<12>, tag<13>, tag<14>, tag<15>,
+                                               tag<16>>;
+    variant_type v{41};
+    mapbox::util::apply_visitor(tag_increment{}, v);
+    REQUIRE(v.get<int>() == 42);
+}
+
+TEST_CASE("table dispatchers can be used for small variants", "[visitor][unary visitor]")
+{
+    using variant_type = mapbox::util::variant<int, double, std::string>;
+    using table = mapbox::util::detail::table_dispatcher<some_visitor&&, variant_type, int, int, double, std::string>;
+    const variant_type var1(123);
+    const variant_type var2(3.2);
+    const variant_type var3("foo");
+    REQUIRE(table::apply_const(var1, some_visitor{1}) == 124);
+    REQUIRE(table::apply_const(var2, some_visitor{1}) == 4);
+    REQUIRE(table::apply_const(var3, some_visitor{1}) == 0);
+}
@@ -549,3 +549,75 @@ TEST_CASE("variant : direct_type helper should match T, references (T&)  and con
     std::uint64_t const& ucr(u);
     REQUIRE(value(ucr).is<std::uint64_t>()); // matches T const&
 }
+
+TEST_CASE("variant of trivially copyable types is trivially copyable", "[variant]")
+{
+    using trivial_type = mapbox::util::variant<int, double, bool>;
+    using non_trivial_type = mapbox::util::variant<int, std::string>;
+    using non_copyable_type = mapbox::util::variant<int, std::unique_ptr<int>>;
+
+    static_assert(std::is_trivially_destructible<trivial_type>::value, "variant of trivial types must be trivially destructible");
+    static_assert(std::is_trivially_copy_constructible<trivial_type>::value, "variant of trivial types must be trivially copy constructible");
+    static_assert(std::is_trivially_move_constructible<trivial_type>::value, "variant of trivial types must be trivially move constructible");
+    static_assert(std::is_trivially_copy_assignable<trivial_type>::value, "variant of trivial types must be trivially copy assignable");
+    static_assert(std::is_trivially_move_assignable<trivial_type>::value, "variant of trivial types must be trivially move assignable");
+    static_assert(!std::is_trivially_destructible<non_trivial_type>::value, "variant of non-trivial types must not be trivially destructible");
+    static_assert(!std::is_trivially_copy_constructible<non_trivial_type>::value, "variant of non-trivial types must not be trivially copy constructible");
+    static_assert(std::is_nothrow_move_constructible<non_trivial_type>::value, "variant of nothrow movable types must be nothrow movable");
+    static_assert(std::is_nothrow_move_constructible<non_copyable_type>::value, "variant of nothrow movable types must be nothrow movable");
+
+    trivial_type a{3.5};
+    trivial_type b{a};
+    REQUIRE(b.get<double>() == Approx(3.5));
+    trivial_type c{true};
+    c = a;
+    REQUIRE(c.get<double>() == Approx(3.5));
+    c = 7;
+    REQUIRE(c.get<int>() == 7);
+    c = std::move(b);
+    REQUIRE(c.get<double>() == Approx(3.5));
+
+    std::vector<trivial_type> vec;
+    for (int i = 0; i < 100; ++i)
+    {
+        vec.emplace_back(i);
+    }
+    REQUIRE(vec.at(99).get<int>() == 99);
+
+    trivial_type d{mapbox::util::no_init()};
+    trivial_type e{d};
+    REQUIRE_FALSE(e.valid());
+}
+
+template <typename T>
+struct tree_node;
+
+using tree = mapbox::util::variant<int, mapbox::util::recursive_wrapper<tree_node<int>>>;
+
+// Instantiates tree, and with it the choice of its copy base, while
+// tree_node<int> is still incomplete.
+struct tree_holder
+{
+    tree value;
+};
+
+template <typename T>
+struct tree_node
+{
+    T weight;
+    tree lhs;
+    tree rhs;
+};
+
+TEST_CASE("variant of a recursive_wrapper of an incomplete type is not trivially copyable", "[variant]")
+{
+    static_assert(!std::is_trivially_copy_constructible<tree>::value, "recursive variant must not be trivially copy constructible");
+    static_assert(!std::is_trivially_destructible<tree>::value, "recursive variant must not be trivially destructible");
+
+    tree_holder h{tree{tree_node<int>{1, tree{2}, tree{3}}}};
+    tree_holder copy = h;
+    REQUIRE(copy.value.get<tree_node<int>>().rhs.get<int>() == 3);
+    copy.value = 4;
+    REQUIRE(h.value.get<tree_node<int>>().weight == 1);
+    REQUIRE(copy.value.get<int>() == 4);
+}
@@ -0,0 +1,134 @@
+#include "catch.hpp"
+
+#include <mapbox/variant.hpp>
+#include <mapbox/variant_collection.hpp>
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using shapes = mapbox::util::variant_collection<int, double, std::string>;
+
+struct record
+{
+    std::vector<std::string> seen;
+
+    void operator()(int i) { seen.push_back("int " + std::to_string(i)); }
+    void operator()(double) { seen.push_back("double"); }
+    void operator()(std::string const& s) { seen.push_back("string " + s); }
+};
+
+struct node;
+
+using tree = mapbox::util::variant_collection<int, mapbox::util::recursive_wrapper<node>>;
+
+struct node
+{
+    int value;
+};
+
+} // namespace
+
+TEST_CASE("variant_collection keeps each alternative in its own segment", "[variant_collection]")
+{
+    shapes c;
+    REQUIRE(c.empty());
+    c.insert(1);
+    c.insert(std::string("two"));
+    c.insert(3);
+    c.emplace<double>(4.5);
+
+    REQUIRE(c.size() == 4);
+    REQUIRE(c.size<int>() == 2);
+    REQUIRE((c.segment<int>() == std::vector<int>{1, 3}));
+    REQUIRE(c.segment<2>().front() == "two");
+
+    c.clear();
+    REQUIRE(c.empty());
+}
+
+TEST_CASE("variant_collection visits segment by segment", "[variant_collection]")
+{
+    using variant_type = mapbox::util::variant<int, double, std::string>;
+    shapes c;
+    c.insert(variant_type{std::string("a")});
+    c.insert(variant_type{1});
+    variant_type const d{2.5};
+    c.insert(d);
+    c.insert(variant_type{2});
+
+    record r;
+    c.for_each(r);
+    REQUIRE((r.seen == std::vector<std::string>{"int 1", "int 2", "double", "string a"}));
+
+    int sum = 0;
+    c.for_each<int>([&sum](int i) { sum += i; });
+    REQUIRE(sum == 3);
+
+    c.for_each(mapbox::util::make_visitor([](int& i) { i *= 10; },
+                                          [](double&) {},
+                                          [](std::string& s) { s += "!"; }));
+    shapes const& cc = c;
+    record after;
+    cc.for_each(after);
+    REQUIRE((after.seen == std::vector<std::string>{"int 10", "int 20", "double", "string a!"}));
+}
+
+TEST_CASE("variant_collection unwraps recursive_wrapper alternatives", "[variant_collection]")
+{
+    tree t;
+    t.insert(node{1});
+    t.emplace<node>(node{2}).value += 10;
+    t.insert(5);
+
+    int sum = 0;
+    t.for_each(mapbox::util::make_visitor([&sum](int i) { sum += i; },
+                                          [&sum](node const& n) { sum += n.value; }));
+    REQUIRE(sum == 18);
+    REQUIRE(t.size<node>() == 2);
+}
+
+TEST_CASE("variant_collection takes recursive_wrapper values as they are", "[variant_collection]")
+{
+    tree t;
+    mapbox::util::recursive_wrapper<node> const w{node{1}};
+    t.insert(w);
+    t.insert(mapbox::util::recursive_wrapper<node>{node{2}});
+    t.emplace<mapbox::util::recursive_wrapper<node>>(node{3}).value += 10;
+
+    REQUIRE(t.size<node>() == 3);
+    REQUIRE(t.segment<node>()[0].get().value == 1);
+    REQUIRE(t.segment<node>()[1].get().value == 2);
+    REQUIRE(t.segment<node>()[2].get().value == 13);
+}
+
+TEST_CASE("variant_collection stores bools a byte each", "[variant_collection]")
+{
+    using numbers = mapbox::util::variant_collection<bool, std::int64_t, double>;
+    numbers c;
+    c.insert(true);
+    c.insert(std::int64_t(3));
+    c.emplace<bool>(true) = false;
+    c.insert(mapbox::util::variant<bool, std::int64_t, double>{true});
+    c.insert(0.5);
+
+    REQUIRE(c.size<bool>() == 3);
+    REQUIRE(sizeof(numbers::segment_type<0>::value_type) == 1);
+    REQUIRE((std::is_same<numbers::cell_type<0>, numbers::bool_cell>::value));
+    REQUIRE_FALSE(c.segment<bool>()[1].value);
+
+    int flags = 0;
+    double total = 0;
+    c.for_each(mapbox::util::make_visitor([&flags](bool& b) { flags += b ? 1 : 0; b = !b; },
+                                          [&total](std::int64_t i) { total += static_cast<double>(i); },
+                                          [&total](double d) { total += d; }));
+    REQUIRE(flags == 2);
+    REQUIRE(total == 3.5);
+    numbers const& cc = c;
+    cc.for_each<bool>([&flags](bool b) { flags += b ? 1 : 0; });
+    REQUIRE(flags == 3);
+}
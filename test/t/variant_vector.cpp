@@ -0,0 +1,279 @@
+#include "catch.hpp"
+
+#include <mapbox/variant.hpp>
+#include <mapbox/variant_vector.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using values = mapbox::util::variant_vector<int, double, std::string>;
+
+struct describe
+{
+    std::string operator()(int i) const { return "int " + std::to_string(i); }
+    std::string operator()(double) const { return "double"; }
+    std::string operator()(std::string const& s) const { return "string " + s; }
+};
+
+struct node;
+
+using tree = mapbox::util::variant_vector<int, mapbox::util::recursive_wrapper<node>>;
+
+struct node
+{
+    int value;
+};
+
+} // namespace
+
+TEST_CASE("variant_vector stores each alternative in its own column", "[variant_vector]")
+{
+    values v;
+    REQUIRE(v.empty());
+    v.push_back(1);
+    v.push_back(2.5);
+    v.push_back(std::string("three"));
+    v.emplace_back<int>(4);
+
+    REQUIRE(v.size() == 4);
+    REQUIRE((v.tags() == std::vector<values::tag_type>{0, 1, 2, 0}));
+    REQUIRE((v.offsets() == std::vector<values::offset_type>{0, 0, 0, 1}));
+    REQUIRE((v.column<0>() == std::vector<int>{1, 4}));
+    REQUIRE(v.column<1>().size() == 1);
+    REQUIRE(v.column<2>().front() == "three");
+    REQUIRE(values::tag_of<std::string>() == 2);
+
+    // The columns can be written in place but not resized.
+    static_assert(std::is_same<decltype(v.column<0>()), std::vector<int> const&>::value, "columns must be read only");
+    mapbox::util::column_span<int> const ints = v.values<0>();
+    REQUIRE(ints.size() == 2);
+    ints[1] = 40;
+    for (int& i : ints)
+    {
+        i += 1;
+    }
+    REQUIRE(v[0].get<int>() == 2);
+    REQUIRE(v[3].get<int>() == 41);
+}
+
+TEST_CASE("variant_vector references support is, get and apply_visitor", "[variant_vector]")
+{
+    values v;
+    v.push_back(1);
+    v.push_back(std::string("two"));
+
+    REQUIRE(v[0].which() == 0);
+    REQUIRE(v[0].is<int>());
+    REQUIRE_FALSE(v[0].is<std::string>());
+    REQUIRE(v[0].get<int>() == 1);
+    REQUIRE_THROWS_AS(v[0].get<double>(), mapbox::util::bad_variant_access&);
+    REQUIRE(v[1].get_unchecked<std::string>() == "two");
+
+    v[0].get<int>() = 10;
+    REQUIRE(v.column<0>().front() == 10);
+
+    REQUIRE(mapbox::util::apply_visitor(describe{}, v[0]) == "int 10");
+    values const& c = v;
+    REQUIRE(mapbox::util::apply_visitor(describe{}, c[1]) == "string two");
+    REQUIRE(c[1].match([](int) { return 0; },
+                       [](double) { return 1; },
+                       [](std::string const& s) { return static_cast<int>(s.size()); }) == 3);
+
+    mapbox::util::variant<int, double, std::string> const copy = v[1];
+    REQUIRE(copy.get<std::string>() == "two");
+}
+
+TEST_CASE("variant_vector iterates over its elements in order", "[variant_vector]")
+{
+    values v;
+    v.push_back(1);
+    v.push_back(2.0);
+    v.push_back(3);
+
+    std::vector<std::string> seen;
+    for (auto ref : v)
+    {
+        seen.push_back(mapbox::util::apply_visitor(describe{}, ref));
+    }
+    REQUIRE((seen == std::vector<std::string>{"int 1", "double", "int 3"}));
+
+    values::const_iterator const first = v.begin();
+    REQUIRE(v.end() - first == 3);
+    REQUIRE(first[2].get<int>() == 3);
+    REQUIRE(std::count_if(v.cbegin(), v.cend(), [](values::const_reference r) { return r.is<int>(); }) == 2);
+}
+
+TEST_CASE("variant_vector appends variants and pops from the back", "[variant_vector]")
+{
+    using variant_type = mapbox::util::variant<int, double, std::string>;
+    values v;
+    variant_type const s{std::string("copied")};
+    v.push_back(s);
+    v.push_back(variant_type{1.5});
+    REQUIRE(v[0].get<std::string>() == "copied");
+    REQUIRE(v[1].get<double>() == 1.5);
+
+    v.pop_back();
+    REQUIRE(v.size() == 1);
+    REQUIRE(v.column<1>().empty());
+    v.clear();
+    REQUIRE(v.empty());
+    REQUIRE(v.column<2>().empty());
+}
+
+TEST_CASE("variant_vector unwraps recursive_wrapper alternatives", "[variant_vector]")
+{
+    tree t;
+    t.push_back(node{7});
+    t.emplace_back<node>(node{8});
+    t.push_back(1);
+    REQUIRE(t[0].is<node>());
+    REQUIRE(t[1].get<node>().value == 8);
+    REQUIRE(t.column<1>().size() == 2);
+    REQUIRE(t[2].match([](int i) { return i; }, [](node const& n) { return n.value; }) == 1);
+}
+
+TEST_CASE("variant_vector takes recursive_wrapper values as they are", "[variant_vector]")
+{
+    tree t;
+    mapbox::util::recursive_wrapper<node> const w{node{2}};
+    t.push_back(w);
+    t.push_back(mapbox::util::recursive_wrapper<node>{node{3}});
+    node& n = t.emplace_back<mapbox::util::recursive_wrapper<node>>(node{4});
+    REQUIRE(&n == &t[2].get<node>());
+
+    REQUIRE(t.column<1>().size() == 3);
+    REQUIRE(t[0].get<node>().value == 2);
+    REQUIRE(t[1].get<node>().value == 3);
+    REQUIRE(n.value == 4);
+}
+
+TEST_CASE("variant_vector stores bools a byte each", "[variant_vector]")
+{
+    using flags = mapbox::util::variant_vector<bool, int>;
+    flags v;
+    v.push_back(true);
+    v.push_back(2);
+    v.emplace_back<bool>(false) = true;
+    v.push_back(mapbox::util::variant<bool, int>{false});
+
+    REQUIRE(v.size() == 4);
+    REQUIRE(v.column<0>().size() == 3);
+    REQUIRE(sizeof(flags::column_type<0>::value_type) == 1);
+    REQUIRE((std::is_same<flags::cell_type<0>, flags::bool_cell>::value));
+    REQUIRE((std::is_same<flags::cell_type<1>, int>::value));
+    REQUIRE((std::is_same<decltype(v.values<0>()[0]), flags::bool_cell&>::value));
+    REQUIRE(v[2].get<bool>());
+    v[0].get<bool>() = false;
+    REQUIRE_FALSE(v.column<0>()[0].value);
+    REQUIRE(v[1].match([](bool b) { return b ? 1 : 0; }, [](int i) { return i; }) == 2);
+    REQUIRE_FALSE((mapbox::util::variant<bool, int>(v[3]).get<bool>()));
+}
+
+TEST_CASE("variant_vector appends runs of one alternative", "[variant_vector]")
+{
+    mapbox::util::variant_vector<bool, int> v;
+    v.push_back(true);
+    v.push_back(2);
+    std::vector<bool> const flags = {false, true};
+    v.append<bool>(flags.begin(), flags.end());
+
+    REQUIRE(v.size() == 4);
+    REQUIRE((v.tags() == std::vector<std::uint8_t>{0, 1, 0, 0}));
+    REQUIRE((v.offsets() == std::vector<std::uint32_t>{0, 0, 1, 2}));
+    v[2].get<bool>() = true;
+    REQUIRE(v[2].get<bool>());
+    REQUIRE(v.column<0>()[2].value);
+    REQUIRE(v[3].match([](bool b) { return b ? 1 : 0; }, [](int i) { return i; }) == 1);
+}
+
+namespace {
+
+struct throwing_default
+{
+    throwing_default() { throw std::runtime_error("no default"); }
+    explicit throwing_default(int) {}
+};
+
+} // namespace
+
+TEST_CASE("variant_vector assign_tags leaves the container empty when it throws", "[variant_vector]")
+{
+    mapbox::util::variant_vector<int, throwing_default> v;
+    v.push_back(1);
+    v.emplace_back<throwing_default>(2);
+    v.push_back(3);
+
+    auto const alternating = [](std::size_t i) { return static_cast<std::uint8_t>(i % 2); };
+    REQUIRE_THROWS_AS(v.assign_tags(4, alternating), std::runtime_error&);
+    REQUIRE(v.empty());
+    REQUIRE(v.offsets().empty());
+    REQUIRE(v.column<0>().empty());
+    REQUIRE(v.column<1>().empty());
+
+    auto const failing_tag = [](std::size_t i) -> std::uint8_t {
+        if (i == 2)
+        {
+            throw std::runtime_error("no tag");
+        }
+        return 0;
+    };
+    v.push_back(5);
+    REQUIRE_THROWS_AS(v.assign_tags(3, failing_tag), std::runtime_error&);
+    REQUIRE(v.empty());
+    REQUIRE(v.column<0>().empty());
+
+    v.assign_tags(3, [](std::size_t) { return std::uint8_t(0); });
+    REQUIRE((v.column<0>() == std::vector<int>{0, 0, 0}));
+    REQUIRE((v.offsets() == std::vector<std::uint32_t>{0, 1, 2}));
+}
+
+TEST_CASE("variant_vector assign_tags rejects bad tags and sizes", "[variant_vector]")
+{
+    mapbox::util::variant_vector<int, double> v;
+    v.push_back(1);
+
+    auto const bad_tag = [](std::size_t i) { return static_cast<std::uint8_t>(i == 1 ? 2 : 0); };
+    REQUIRE_THROWS_AS(v.assign_tags(3, bad_tag), std::invalid_argument&);
+    REQUIRE(v.empty());
+    REQUIRE(v.column<0>().empty());
+
+    // Tags are checked before they are narrowed to std::uint8_t.
+    v.push_back(1);
+    auto const wide_tag = [](std::size_t i) { return i == 1 ? 256 : 0; };
+    REQUIRE_THROWS_AS(v.assign_tags(3, wide_tag), std::invalid_argument&);
+    REQUIRE(v.empty());
+
+    auto const negative_tag = [](std::size_t i) { return i == 1 ? -1 : 1; };
+    REQUIRE_THROWS_AS(v.assign_tags(3, negative_tag), std::invalid_argument&);
+    REQUIRE(v.empty());
+
+    auto const int_tag = [](std::size_t i) { return static_cast<int>(i % 2); };
+    v.assign_tags(3, int_tag);
+    REQUIRE(v.size() == 3);
+    REQUIRE(v.column<1>().size() == 1);
+
+    v.push_back(1);
+    auto const first = [](std::size_t) { return std::uint8_t(0); };
+    REQUIRE_THROWS_AS(v.assign_tags(v.max_size() + 1, first), std::length_error&);
+    REQUIRE(v.empty());
+}
+
+TEST_CASE("variant_vector limits the number of elements, not of values per alternative", "[variant_vector]")
+{
+    mapbox::util::variant_vector<int, double> v;
+    v.push_back(1.5);
+
+    // The int column is empty, but the elements would not fit.
+    REQUIRE_THROWS_AS(v.append(v.max_size(), 1), std::length_error&);
+    REQUIRE(v.size() == 1);
+    REQUIRE(v.column<0>().empty());
+}
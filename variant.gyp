@@ -8,16 +8,31 @@
       "type": "executable",
       "sources": [
         "test/unit.cpp",
+        "test/t/assignment.cpp",
         "test/t/binary_visitor_1.cpp",
         "test/t/binary_visitor_2.cpp",
         "test/t/binary_visitor_3.cpp",
         "test/t/binary_visitor_4.cpp",
         "test/t/binary_visitor_5.cpp",
         "test/t/binary_visitor_6.cpp",
+        "test/t/binary_visitor_7.cpp",
+        "test/t/emplace.cpp",
         "test/t/issue21.cpp",
         "test/t/mutating_visitor.cpp",
+        "test/t/nary_visitor.cpp",
         "test/t/optional.cpp",
+        "test/t/pool_allocator.cpp",
         "test/t/recursive_wrapper.cpp",
+        "test/t/recursive_wrapper_allocator.cpp",
+        "test/t/shared_recursive_wrapper.cpp",
+        "test/t/interner.cpp",
+        "test/t/reclaimer.cpp",
+        "test/t/deep_size.cpp",
+        "test/t/variant_vector.cpp",
+        "test/t/variant_collection.cpp",
+        "test/t/tag_algorithms.cpp",
+        "test/t/tag_algorithms_scalar.cpp",
+        "test/t/numeric_kernels.cpp",
         "test/t/sizeof.cpp",
         "test/t/unary_visitor.cpp",
         "test/t/variant.cpp"
@@ -30,6 +45,44 @@
           "./include",
           "test/include"
       ]
+    },
+    {
+      "target_name": "instrumentation_tests",
+      "type": "executable",
+      "sources": [
+        "test/unit.cpp",
+        "test/t/instrumentation.cpp"
+      ],
+      "defines": [
+        "MAPBOX_VARIANT_INSTRUMENTATION"
+      ],
+      "xcode_settings": {
+        "SDKROOT": "macosx",
+        "SUPPORTED_PLATFORMS":["macosx"]
+      },
+      "include_dirs": [
+          "./include",
+          "test/include"
+      ]
+    },
+    {
+      "target_name": "allocation_tracker_tests",
+      "type": "executable",
+      "sources": [
+        "test/unit.cpp",
+        "test/t/allocation_tracker.cpp"
+      ],
+      "defines": [
+        "MAPBOX_VARIANT_TRACK_ALLOCATIONS"
+      ],
+      "xcode_settings": {
+        "SDKROOT": "macosx",
+        "SUPPORTED_PLATFORMS":["macosx"]
+      },
+      "include_dirs": [
+          "./include",
+          "test/include"
+      ]
     }
   ]
 }